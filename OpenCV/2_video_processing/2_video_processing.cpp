@@ -1,5 +1,9 @@
 #include <opencv2/opencv.hpp>
+#include <fstream>
 #include <iostream>
+#include "frame_pipeline.h"
+#include "motion_gate.h"
+#include "streaming_optical_flow.h"
 
 int main() {
     // Open the default camera
@@ -23,29 +27,65 @@ int main() {
         return -1;
     }
 
+    // Frames without motion are neither encoded nor displayed; the sidecar file lists them, one capture index
+    // per line, so the original timing can be restored by repeating the previous frame
+    MotionGate gate;
+    std::ofstream duplicates("/tmp/output.duplicates");
+    if (!duplicates.is_open()) {
+        std::cerr << "Could not open the duplicate frame list for write" << std::endl;
+        return -1;
+    }
+
     // Create a window for display.
     cv::namedWindow("Camera Output", cv::WINDOW_AUTOSIZE);
 
-    while (true) {
-        cv::Mat frame;
-        // Capture frame-by-frame
-        capture >> frame;
+    // Capture runs on its own thread, so grabbing the next frame overlaps with encoding and displaying this one
+    FramePipeline pipeline(1, 4);
+    // Frames reach the sink in order, so the tracker can reuse each frame's pyramid for the next one
+    StreamingOpticalFlow flow;
+    cv::Mat display;
+    pipeline.run(
+            // Capture frame-by-frame; no frame ends the stream. The motion gate runs here, on the capture thread,
+            // and an unchanged frame is passed on empty, as a marker
+            [&](cv::Mat& frame) {
+                capture >> frame;
+                if (frame.empty())
+                    return false;
+                if (!gate.update(frame))
+                    frame.release();
+                return true;
+            },
+            // No filtering in this example, the frame is passed on as it is
+            [] {
+                return [](const cv::Mat& frame, cv::Mat& result) { result = frame; };
+            },
+            // Write and display the frames in capture order
+            [&](const FramePacket& packet) {
+                if (packet.result.empty()) {
+                    // Same as the previous frame: only the marker is written, the window keeps showing that frame
+                    duplicates << packet.index << '\n';
+                } else {
+                    // Write the frame into the file
+                    videoWriter.write(packet.result);
 
-        // If the frame is empty, break immediately
-        if (frame.empty())
-            break;
+                    // Display the resulting frame with the tracked features
+                    flow.update(packet.result);
+                    packet.result.copyTo(display);
+                    flow.draw(display);
+                    cv::imshow("Camera Output", display);
+                }
 
-        // Write the frame into the file
-        videoWriter.write(frame);
+                // Print the queue depths from time to time
+                if (packet.index % 100 == 99)
+                    std::cout << pipeline.stats() << std::endl;
 
-        // Display the resulting frame
-        cv::imshow("Camera Output", frame);
+                // Press ESC on keyboard to exit
+                char c = (char)cv::waitKey(25);
+                return c != 27; // ASCII value for ESC
+            });
 
-        // Press ESC on keyboard to exit
-        char c = (char)cv::waitKey(25);
-        if (c == 27) // ASCII value for ESC
-            break;
-    }
+    std::cout << "Frames written: " << gate.framesPassed() << ", unchanged frames skipped: " << gate.framesSkipped()
+              << std::endl;
 
     // When everything done, release the video capture and write object
     capture.release();
@@ -0,0 +1,44 @@
+#include "motion_gate.h"
+
+MotionGate::MotionGate(const MotionGateOptions& options) : options(options) {
+    CV_Assert(options.analysisSize.area() > 0 && options.stopFraction <= options.startFraction);
+}
+
+bool MotionGate::update(const cv::Mat& frame) {
+    CV_Assert(!frame.empty());
+    cv::resize(frame, small, options.analysisSize, 0, 0, cv::INTER_AREA);
+    if (small.channels() == 1)
+        gray = small;
+    else
+        cv::cvtColor(small, gray, small.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+
+    if (background.empty()) {
+        // Nothing to compare the first frame with, it is always kept
+        gray.convertTo(background, CV_32F);
+        ++passed;
+        return true;
+    }
+
+    background.convertTo(backgroundGray, CV_8U);
+    cv::absdiff(gray, backgroundGray, difference);
+    fraction = static_cast<double>(cv::countNonZero(difference > options.pixelThreshold)) / difference.total();
+    // The background follows slow changes (light, auto exposure) so they do not count as motion forever
+    cv::accumulateWeighted(gray, background, options.learningRate);
+
+    if (fraction >= options.startFraction) {
+        active = true;
+        quietFrames = 0;
+    } else if (active) {
+        // Between the two thresholds the motion goes on
+        if (fraction >= options.stopFraction)
+            quietFrames = 0;
+        else if (++quietFrames > options.holdFrames)
+            active = false;
+    }
+
+    if (active)
+        ++passed;
+    else
+        ++skipped;
+    return active;
+}
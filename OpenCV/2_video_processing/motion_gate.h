@@ -0,0 +1,41 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+struct MotionGateOptions {
+    cv::Size analysisSize{160, 120};  // Frames are compared at this size
+    double learningRate = 0.05;       // Weight of a new frame in the running-average background
+    int pixelThreshold = 25;          // A gray level difference above this counts as change
+    // Hysteresis on the fraction of changed pixels: motion starts above startFraction and only ends once the
+    // fraction has stayed below stopFraction for holdFrames frames, so noise and pauses in a movement do not
+    // switch the gate on and off
+    double startFraction = 0.01;
+    double stopFraction = 0.003;
+    int holdFrames = 15;
+};
+
+// Decides whether a camera frame shows anything new. Every frame is reduced to a small gray image (INTER_AREA
+// averages away the sensor noise) and compared with a running average of the previous ones; the cost is a
+// fraction of what filtering and encoding the full frame would take.
+class MotionGate {
+public:
+    explicit MotionGate(const MotionGateOptions& options = MotionGateOptions());
+
+    // True if the frame has to be processed: there is motion, it ended less than holdFrames frames ago, or it is
+    // the first frame. Frames must be passed in order.
+    bool update(const cv::Mat& frame);
+
+    bool motion() const { return active; }
+    double changedFraction() const { return fraction; }
+    uint64_t framesPassed() const { return passed; }
+    uint64_t framesSkipped() const { return skipped; }
+
+private:
+    MotionGateOptions options;
+    cv::Mat small, gray, background, backgroundGray, difference;
+    bool active = false;
+    int quietFrames = 0;
+    double fraction = 0;
+    uint64_t passed = 0;
+    uint64_t skipped = 0;
+};
@@ -1,5 +1,9 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include "async_image_writer.h"
+#include "preview_loader.h"
+#include "raw_frame_store.h"
+#include "resource_cache.h"
 
 int slider_value = 0;
 
@@ -7,32 +11,54 @@ void on_trackbar(int, void*) {
     std::cout << "Slider value: " << slider_value << std::endl;
 }
 
-#ifndef RESOURCES_PATH
-#define RESOURCES_PATH "Undefined"
-#endif
-
 int main() {
     // 3.1 Reading an Image
 
-    std::string resources_path = RESOURCES_PATH;
-    std::string image_path = resources_path + "OpenCV/lenna.jpg"; // Update the path accordingly
+    std::string image_path = resourcePath("OpenCV/lenna.jpg");
     std::cout << image_path <<std::endl;
-    cv::Mat image = cv::imread(image_path, cv::IMREAD_COLOR);
+    // Same as cv::imread, but the decoded pixels are cached next to the image: later runs map them instead of decoding
+    cv::Mat image = loadCachedImage(image_path, cv::IMREAD_COLOR);
     if (image.empty()) {
         std::cerr << "Could not read the image" << std::endl;
         return 1;
     }
 
     // 3.2 Writing an Image
-    bool isSaved = cv::imwrite("output.png", image, {cv::IMWRITE_PNG_COMPRESSION, 9});
-    if (!isSaved) {
-        std::cerr << "Failed to save the image" << std::endl;
+    // Encoded on a worker thread while the windows below are opened. Level 1 is the fastest zlib setting;
+    // 9 makes the file only slightly smaller at several times the cost
+    AsyncImageWriter imageWriter;
+    std::future<ImageWriteResult> saved = imageWriter.write(image, "output.png", {cv::IMWRITE_PNG_COMPRESSION, 1});
+
+    // Intermediate results that are read back by the next step can skip encoding altogether:
+    // the raw frame file is mapped into memory and the Mat points into the mapping
+    {
+        RawFrameWriter writer("output.cvraw", false);
+        if (!writer.write(image))
+            std::cerr << "Failed to save the raw frame" << std::endl;
     }
+    RawFrameReader rawFrames("output.cvraw");
+    if (rawFrames.frameCount() > 0)
+        std::cout << "Raw frame mapped without decoding: " << rawFrames.frame(0).size() << std::endl;
 
     // 3.3 Displaying Images
     cv::namedWindow("Display window", cv::WINDOW_AUTOSIZE);
     cv::imshow("Display window", image);
 
+    // A thumbnail does not need the full decode: the JPEG is decoded at a reduced size and then area resampled.
+    // One image needs no pool of decode threads
+    PreviewLoader previews(1);
+    cv::Mat thumbnail = previews.load(image_path, cv::Size(128, 128));
+    if (!thumbnail.empty())
+        cv::imshow("Thumbnail", thumbnail);
+
+    ImageWriteResult writeResult = saved.get();
+    if (!writeResult.ok) {
+        std::cerr << "Failed to save the image" << std::endl;
+    } else {
+        std::cout << "Saved " << writeResult.path << " (" << writeResult.bytes << " bytes, encoded in "
+                  << writeResult.encodeMs << " ms)" << std::endl;
+    }
+
     // 3.4 Window Management
     cv::namedWindow("Example Window", cv::WINDOW_NORMAL);
     cv::resizeWindow("Example Window", 600, 400);
@@ -1,45 +1,45 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include "batch_driver.h"
+#include "integral_image.h"
+#include "median_filter.h"
+#include "panel_grid.h"
+#include "resource_cache.h"
 
-#ifndef RESOURCES_PATH
-#define RESOURCES_PATH "Undefined"
-#endif
+int main(int argc, char** argv) {
+    // Headless batch mode, e.g. --input "images/*.jpg" --output results (see --help)
+    if (argc > 1)
+        return runBatchFromCommandLine(argc, argv, "blur,gaussian,median", 9);
 
-int main() {
-    // Adjust the path to the image according to your setup
-    std::string resources_path = RESOURCES_PATH;
-    std::string imagePath = resources_path + std::string("OpenCV/lenna.jpg");
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
 
-    // Read the image
-    cv::Mat image = cv::imread(imagePath);
+    cv::Mat image = loadCachedImage(imagePath);
     if (image.empty()) {
         std::cerr << "Could not read the image: " << imagePath << std::endl;
         return 1;
     }
 
-    // Create blurred images using different methods
-    cv::Mat blurImage, gaussianBlurImage, medianBlurImage;
-    cv::blur(image, blurImage, cv::Size(9, 9)); // Normal blurring
-    cv::GaussianBlur(image, gaussianBlurImage, cv::Size(9, 9), 0); // Gaussian blurring
-    cv::medianBlur(image, medianBlurImage, 9); // Median blurring
+    // Sum tables of the frame, built once: any box size is then 4 lookups per pixel
+    IntegralImage integral(image, 15);
+    cv::Mat mean, variance;
+    integral.localMeanVariance(mean, variance, cv::Size(15, 15));
+    cv::Scalar channelVariance = cv::mean(variance);
+    std::cout << "Mean local variance (15x15, a focus measure): "
+              << (channelVariance[0] + channelVariance[1] + channelVariance[2]) / 3 << std::endl;
+
+    // Grid display 2x2: every method writes its result directly into its quadrant, all of them concurrently
+    PanelGrid grid(image.size(), image.type(), 2, 2);
+    grid.add(image)
+        .add([&](cv::Mat& view) { integral.boxMean(view, cv::Size(9, 9)); }) // Normal blurring, same as cv::blur from the sum table
+        .add([&](cv::Mat& view) { cv::GaussianBlur(image, view, cv::Size(9, 9), 0); }) // Gaussian blurring
+        .add([&](cv::Mat& view) { medianBlurCT(image, view, 9); }); // Median blurring, same as cv::medianBlur but in constant time per pixel
 
     // Create a window to display results
     cv::namedWindow("Blurring Techniques", cv::WINDOW_AUTOSIZE);
 
-    // Grid display 2x2
-    int grid_size = 2;
-    int rows = image.rows;
-    int cols = image.cols;
-    cv::Mat displayImage(2 * rows, 2 * cols, image.type());
-
-    // Place images in their respective quadrants
-    image.copyTo(displayImage(cv::Rect(0, 0, cols, rows)));
-    blurImage.copyTo(displayImage(cv::Rect(cols, 0, cols, rows)));
-    gaussianBlurImage.copyTo(displayImage(cv::Rect(0, rows, cols, rows)));
-    medianBlurImage.copyTo(displayImage(cv::Rect(cols, rows, cols, rows)));
-
     // Show the result in the window
-    cv::imshow("Blurring Techniques", displayImage);
+    cv::imshow("Blurring Techniques", grid.render());
 
     // Wait for a key press indefinitely
     cv::waitKey(0);
@@ -1,49 +1,40 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include "batch_driver.h"
+#include "edge_engine.h"
+#include "panel_grid.h"
+#include "resource_cache.h"
 
-#ifndef RESOURCES_PATH
-#define RESOURCES_PATH "Undefined"
-#endif
+int main(int argc, char** argv) {
+    // Headless batch mode, e.g. --input "images/*.jpg" --output results (see --help)
+    if (argc > 1)
+        return runBatchFromCommandLine(argc, argv, "sobel,laplacian,canny", 3);
 
-int main() {
-    // Adjust the path to the image according to your setup
-    std::string resources_path = RESOURCES_PATH;
-    std::string imagePath = resources_path + std::string("OpenCV/lenna.jpg");
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
 
-    // Read the image
-    cv::Mat image = cv::imread(imagePath, cv::IMREAD_GRAYSCALE);
+    cv::Mat image = loadCachedImage(imagePath, cv::IMREAD_GRAYSCALE);
     if (image.empty()) {
         std::cerr << "Could not read the image: " << imagePath << std::endl;
         return 1;
     }
 
-    // Create edge-detected images using different methods
-    cv::Mat sobelEdges, laplacianEdges, cannyEdges;
-    cv::Sobel(image, sobelEdges, CV_64F, 1, 1); // Sobel edge detection
-    cv::Laplacian(image, laplacianEdges, CV_64F); // Laplacian edge detection
-    cv::Canny(image, cannyEdges, 50, 150); // Canny edge detection
+    // Compute the derivatives once, in 16-bit integers; all three detectors are derived from them
+    EdgeEngine edges;
+    edges.compute(image);
 
-    // Convert floating point images to 8-bit images
-    cv::convertScaleAbs(sobelEdges, sobelEdges);
-    cv::convertScaleAbs(laplacianEdges, laplacianEdges);
+    // Grid display 2x2: every method writes its result directly into its quadrant, all of them concurrently
+    PanelGrid grid(image.size(), image.type(), 2, 2);
+    grid.add(image)
+        .add([&](cv::Mat& view) { cv::convertScaleAbs(edges.dxy(), view); }) // Sobel edge detection, same as cv::Sobel(image, ..., 1, 1)
+        .add([&](cv::Mat& view) { cv::convertScaleAbs(edges.laplacian(), view); }) // Laplacian edge detection
+        .add([&](cv::Mat& view) { edges.canny(view, 50, 150); }); // Canny edge detection, reuses dx and dy
 
     // Create a window to display results
     cv::namedWindow("Edge Detection Techniques", cv::WINDOW_AUTOSIZE);
 
-    // Grid display 2x2
-    int grid_size = 2;
-    int rows = image.rows;
-    int cols = image.cols;
-    cv::Mat displayImage(2 * rows, 2 * cols, image.type());
-
-    // Place images in their respective quadrants
-    image.copyTo(displayImage(cv::Rect(0, 0, cols, rows)));
-    sobelEdges.copyTo(displayImage(cv::Rect(cols, 0, cols, rows)));
-    laplacianEdges.copyTo(displayImage(cv::Rect(0, rows, cols, rows)));
-    cannyEdges.copyTo(displayImage(cv::Rect(cols, rows, cols, rows)));
-
     // Show the result in the window
-    cv::imshow("Edge Detection Techniques", displayImage);
+    cv::imshow("Edge Detection Techniques", grid.render());
 
     // Wait for a key press indefinitely
     cv::waitKey(0);
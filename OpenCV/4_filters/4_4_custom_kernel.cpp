@@ -1,17 +1,19 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include "batch_driver.h"
+#include "kernel_engine.h"
+#include "panel_grid.h"
+#include "resource_cache.h"
 
-#ifndef RESOURCES_PATH
-#define RESOURCES_PATH "Undefined"
-#endif
+int main(int argc, char** argv) {
+    // Headless batch mode, e.g. --input "images/*.jpg" --output results (see --help)
+    if (argc > 1)
+        return runBatchFromCommandLine(argc, argv, "custom", 3);
 
-int main() {
-    // Adjust the path to the image according to your setup
-    std::string resources_path = RESOURCES_PATH;
-    std::string imagePath = resources_path + std::string("OpenCV/lenna.jpg");
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
 
-    // Read the image
-    cv::Mat image = cv::imread(imagePath);
+    cv::Mat image = loadCachedImage(imagePath);
     if (image.empty()) {
         std::cerr << "Could not read the image: " << imagePath << std::endl;
         return 1;
@@ -23,26 +25,28 @@ int main() {
             -1,  5, -1,
             0, -1,  0);
 
-    // Create an image for the filter output
-    cv::Mat filteredImage;
+    // The engine analyses the kernel once and picks the cheapest way to apply it
+    // (same result as cv::filter2D(image, filteredImage, -1, kernel))
+    CustomKernelFilter customFilter(kernel);
+    std::cout << "Kernel rank " << customFilter.rank() << ", applied with the "
+              << kernelPathName(customFilter.path(image.depth())) << " path" << std::endl;
 
-    // Apply the custom kernel filter
-    cv::filter2D(image, filteredImage, -1, kernel);
+    // A rank-1 kernel is never sent to the DFT: a 31x31 Gaussian runs as two passes of 31 taps
+    cv::Mat gaussian1D = cv::getGaussianKernel(31, -1, CV_32F);
+    cv::Mat gaussian = gaussian1D * gaussian1D.t();
+    if (CustomKernelFilter(gaussian).path(image.depth()) != KernelPath::Separable)
+        std::cerr << "The 31x31 Gaussian kernel is not applied with the separable path" << std::endl;
+
+    // Display images side by side; the filter writes directly into the right half
+    PanelGrid grid(image.size(), image.type(), 2, 1);
+    grid.add(image)
+        .add([&](cv::Mat& view) { customFilter.apply(image, view); }); // Apply the custom kernel filter
 
     // Create a window to display results
     cv::namedWindow("Custom Kernel Effect", cv::WINDOW_AUTOSIZE);
 
-    // Display images side by side
-    int rows = image.rows;
-    int cols = image.cols;
-    cv::Mat displayImage(rows, 2 * cols, image.type());
-
-    // Place images next to each other
-    image.copyTo(displayImage(cv::Rect(0, 0, cols, rows)));
-    filteredImage.copyTo(displayImage(cv::Rect(cols, 0, cols, rows)));
-
     // Show the result in the window
-    cv::imshow("Custom Kernel Effect", displayImage);
+    cv::imshow("Custom Kernel Effect", grid.render());
 
     // Wait for a key press indefinitely
     cv::waitKey(0);
@@ -1,5 +1,10 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
+#include <memory>
+#include "analysis_scaler.h"
+#include "frame_pipeline.h"
+#include "streaming_optical_flow.h"
+#include "tiled_filter_pipeline.h"
 
 int main() {
     cv::VideoCapture cap("traffic_video.mp4");
@@ -8,49 +13,55 @@ int main() {
         return -1;
     }
 
-    // Prepare kernels for morphology and custom filtering
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(5, 5));
-    cv::Mat customKernel = (cv::Mat_<float>(3,3) <<
-                                                 0, -1,  0,
-            -1,  5, -1,
-            0, -1,  0);  // Example of a sharpening kernel
+    // Kernels of the chain: the defaults are a 5x5 Gaussian blur, 3x3 Sobel, 5x5 close and a 3x3 sharpening kernel
+    FilterChainParams params;
 
-    // Variables to hold intermediate results
-    cv::Mat frame, blurred, grad_x, grad_y;
-    cv::Mat abs_grad_x, abs_grad_y, edge_detected;
-    cv::Mat morphology_output, customFiltered;
+    // Decoding, filtering and displaying run as overlapping stages:
+    // one decode thread, one filter worker and the display on the main thread.
+    // A single worker, because the tiled pipeline already uses all cores for every frame.
+    FramePipeline pipeline(1, 4);
+    FilterChainBuffers reference;
+    // Tracks features of the original frames in the sink, where they arrive in order. The flow is computed on
+    // frames reduced to fit into 640x480 and the points are mapped back to the full frame for drawing.
+    StreamingOpticalFlow flow;
+    AnalysisScaler scaler(cv::Size(640, 480));
+    cv::Mat display;
 
-    while (true) {
-        if (!cap.read(frame)) // If no frame is read or video ends
-            break;
+    pipeline.run(
+            // Read the next frame; false if no frame is read or video ends
+            [&](cv::Mat& frame) { return cap.read(frame); },
+            // The worker owns a pipeline, which runs Gaussian blur -> Sobel -> convertScaleAbs ->
+            // addWeighted -> close -> filter2D tile by tile on all cores instead of seven full-frame passes
+            [&] {
+                auto tiled = std::make_shared<TiledFilterPipeline>(params);
+                return [tiled](const cv::Mat& frame, cv::Mat& customFiltered) {
+                    tiled->process(frame, customFiltered);
+                };
+            },
+            [&](const FramePacket& packet) {
+                // Check once that the tiled result matches the full-frame passes
+                if (packet.index == 0) {
+                    applyFilterChain(packet.source, reference, params);
+                    if (cv::norm(reference.customFiltered, packet.result, cv::NORM_INF) != 0)
+                        std::cerr << "Tiled pipeline output differs from the full-frame filter chain" << std::endl;
+                }
 
-        // Apply Gaussian blur
-        cv::GaussianBlur(frame, blurred, cv::Size(5, 5), 0);
+                // Display the resulting frame with the motion of the tracked features
+                packet.result.copyTo(display);
+                for (const TrackedPoint& point : flow.update(scaler.downscale(packet.source))) {
+                    cv::Point2f position = scaler.toFull(point.position);
+                    cv::line(display, scaler.toFull(point.previous), position, cv::Scalar(0, 255, 0), 2);
+                    cv::circle(display, position, 3, cv::Scalar(0, 255, 0), -1);
+                }
+                cv::imshow("Processed Frame", display);
 
-        // Sobel operators
-        cv::Sobel(blurred, grad_x, CV_16S, 1, 0, 3);
-        cv::Sobel(blurred, grad_y, CV_16S, 0, 1, 3);
+                // Print the queue depths from time to time
+                if (packet.index % 100 == 99)
+                    std::cout << pipeline.stats() << std::endl;
 
-        // Convert gradients to absolute versions
-        cv::convertScaleAbs(grad_x, abs_grad_x);
-        cv::convertScaleAbs(grad_y, abs_grad_y);
-
-        // Combine gradients
-        cv::addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, edge_detected);
-
-        // Apply morphological close
-        cv::morphologyEx(edge_detected, morphology_output, cv::MORPH_CLOSE, kernel);
-
-        // Apply custom filtering
-        cv::filter2D(morphology_output, customFiltered, -1, customKernel);
-
-        // Display the resulting frame
-        cv::imshow("Processed Frame", customFiltered);
-
-        // Break loop on key press
-        if (cv::waitKey(30) >= 0)
-            break;
-    }
+                // Break loop on key press
+                return cv::waitKey(30) < 0;
+            });
 
     // Clean up
     cap.release();
@@ -0,0 +1,278 @@
+#include "batch_driver.h"
+#include "async_image_writer.h"
+#include "edge_engine.h"
+#include "fast_morphology.h"
+#include "kernel_engine.h"
+#include "median_filter.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+// One input image with the intermediate results its filters share. The edge detectors with 3x3 apertures derive
+// their results from a single EdgeEngine pass, computed by the first of them that runs
+class BatchImage {
+public:
+    BatchImage(const cv::Mat& image, int kernelSize)
+        : image(image), laplacianKsize(std::min(kernelSize | 1, 31)) {}
+
+    const cv::Mat image;
+
+    const EdgeEngine& edges() {
+        if (!edgesComputed) {
+            // The Laplacian aperture of the batch if the engine has it, otherwise the laplacian filter does not use it
+            engine.compute(image, laplacianKsize <= 3 ? laplacianKsize : 1);
+            edgesComputed = true;
+        }
+        return engine;
+    }
+
+    // Edge detectors work on the intensity only
+    const cv::Mat& gray() {
+        if (grayImage.empty()) {
+            if (image.channels() == 1)
+                grayImage = image;
+            else
+                cv::cvtColor(image, grayImage, cv::COLOR_BGR2GRAY);
+        }
+        return grayImage;
+    }
+
+    const int laplacianKsize;
+
+private:
+    EdgeEngine engine;
+    bool edgesComputed = false;
+    cv::Mat grayImage;
+};
+
+using BatchFilter = std::function<void(BatchImage& input, cv::Mat& result, int kernelSize)>;
+
+static const std::map<std::string, BatchFilter>& batchFilters() {
+    static const std::map<std::string, BatchFilter> filters = {
+        {"blur", [](BatchImage& input, cv::Mat& result, int k) {
+            cv::blur(input.image, result, cv::Size(k, k));
+        }},
+        {"gaussian", [](BatchImage& input, cv::Mat& result, int k) {
+            cv::GaussianBlur(input.image, result, cv::Size(k | 1, k | 1), 0);
+        }},
+        {"median", [](BatchImage& input, cv::Mat& result, int k) {
+            medianBlurCT(input.image, result, k | 1);
+        }},
+        {"sobel", [](BatchImage& input, cv::Mat& result, int k) {
+            // The mixed derivative is the same for ksize 1 and 3
+            const int ksize = std::min(k | 1, 7);
+            if (ksize <= 3) {
+                cv::convertScaleAbs(input.edges().dxy(), result);
+                return;
+            }
+            cv::Mat edges;
+            cv::Sobel(input.gray(), edges, CV_16S, 1, 1, ksize);
+            cv::convertScaleAbs(edges, result);
+        }},
+        {"laplacian", [](BatchImage& input, cv::Mat& result, int) {
+            if (input.laplacianKsize <= 3) {
+                cv::convertScaleAbs(input.edges().laplacian(), result);
+                return;
+            }
+            cv::Mat edges;
+            cv::Laplacian(input.gray(), edges, CV_16S, input.laplacianKsize);
+            cv::convertScaleAbs(edges, result);
+        }},
+        {"canny", [](BatchImage& input, cv::Mat& result, int k) {
+            const int aperture = std::clamp(k | 1, 3, 7);
+            if (aperture == 3)
+                input.edges().canny(result, 50, 150);
+            else
+                cv::Canny(input.gray(), result, 50, 150, aperture);
+        }},
+        {"dilate", [](BatchImage& input, cv::Mat& result, int k) {
+            fastDilate(input.image, result, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k)));
+        }},
+        {"erode", [](BatchImage& input, cv::Mat& result, int k) {
+            fastErode(input.image, result, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k)));
+        }},
+        {"open", [](BatchImage& input, cv::Mat& result, int k) {
+            fastMorphologyEx(input.image, result, cv::MORPH_OPEN,
+                             cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k)));
+        }},
+        {"custom", [](BatchImage& input, cv::Mat& result, int) {
+            // Sharpening kernel of 4_4_custom_kernel, the kernel size does not apply
+            static const CustomKernelFilter sharpen((cv::Mat_<float>(3,3) <<
+                    0, -1,  0,
+                    -1,  5, -1,
+                    0, -1,  0));
+            sharpen.apply(input.image, result);
+        }},
+    };
+    return filters;
+}
+
+std::vector<std::string> availableBatchFilters() {
+    std::vector<std::string> names;
+    for (const auto& filter : batchFilters())
+        names.push_back(filter.first);
+    return names;
+}
+
+// Nearest-rank percentile of sorted values
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty())
+        return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+BatchReport runBatch(const BatchOptions& options) {
+    std::vector<BatchFilter> filters;
+    for (const std::string& name : options.filters)
+        filters.push_back(batchFilters().at(name));
+
+    if (!options.outputDir.empty()) {
+        std::error_code error;
+        fs::create_directories(options.outputDir, error);
+        if (error)
+            CV_Error(cv::Error::StsError, "Could not create the output directory " + options.outputDir + ": " +
+                                          error.message());
+    }
+
+    struct ImageResult {
+        bool ok = false;
+        double latencyMs = 0;
+        double megapixels = 0;
+        std::vector<std::future<ImageWriteResult>> writes;  // An image whose results were not written failed
+    };
+
+    // Parallelism comes from processing whole images concurrently,
+    // so OpenCV's own threading is switched off to avoid oversubscribing the cores
+    int previousThreads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    std::vector<std::string> inputs = listBatchInputs(options.input);
+    std::vector<std::future<ImageResult>> pending;
+    // Encoding runs on its own threads, half as many as the filter workers, which go on with the next image meanwhile
+    const size_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    AsyncImageWriter writer(std::max<size_t>(1, threads / 2));
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(threads);
+        for (const std::string& path : inputs) {
+            pending.push_back(pool.submit([&, path] {
+                ImageResult result;
+                auto imageStart = std::chrono::steady_clock::now();
+
+                cv::Mat image = cv::imread(path);
+                if (image.empty())
+                    return result;
+
+                BatchImage input(image, options.kernelSize);
+                for (size_t i = 0; i < filters.size(); ++i) {
+                    // A new result per filter: the writer still reads the previous one
+                    cv::Mat filtered;
+                    filters[i](input, filtered, options.kernelSize);
+                    if (!options.outputDir.empty()) {
+                        std::string name = fs::path(path).stem().string() + "_" + options.filters[i] + ".png";
+                        result.writes.push_back(writer.write(filtered, (fs::path(options.outputDir) / name).string()));
+                    }
+                }
+
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - imageStart;
+                result.ok = true;
+                result.latencyMs = elapsed.count();
+                result.megapixels = image.total() * filters.size() / 1e6;
+                return result;
+            }));
+        }
+    }
+    writer.wait();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    cv::setNumThreads(previousThreads);
+
+    BatchReport report;
+    report.seconds = elapsed.count();
+    report.output = writer.stats();
+    std::vector<double> latencies;
+    for (auto& future : pending) {
+        ImageResult result = future.get();
+        for (auto& write : result.writes)
+            result.ok = write.get().ok && result.ok;
+        if (!result.ok) {
+            ++report.failed;
+            continue;
+        }
+        ++report.images;
+        report.megapixels += result.megapixels;
+        latencies.push_back(result.latencyMs);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    report.latencyP50Ms = percentile(latencies, 0.50);
+    report.latencyP99Ms = percentile(latencies, 0.99);
+    return report;
+}
+
+void printBatchReport(std::ostream& os, const BatchReport& report) {
+    double seconds = std::max(report.seconds, 1e-9);
+    os << "Processed " << report.images << " images (" << report.failed << " failed) in " << report.seconds << " s" << std::endl;
+    os << "Throughput: " << report.images / seconds << " images/s, " << report.megapixels / seconds << " MPix/s" << std::endl;
+    os << "Latency per image: p50 " << report.latencyP50Ms << " ms, p99 " << report.latencyP99Ms << " ms" << std::endl;
+    if (!report.output.empty())
+        os << "Output files by format:" << std::endl << report.output;
+}
+
+int runBatchFromCommandLine(int argc, char** argv, const std::string& defaultFilters, int defaultKernelSize) {
+    const std::string keys =
+            "{help h    |   | print this message}"
+            "{input i   |   | input directory or glob pattern, e.g. frames/*.jpg}"
+            "{filters f |   | comma separated filters (default: the filters of this example)}"
+            "{ksize k   | 0 | kernel size (default: the kernel size of this example)}"
+            "{output o  |   | output directory; results are discarded when not given}"
+            "{threads t | 0 | worker threads, 0 = one per core}";
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Headless batch mode: runs the filters over every input image and reports the throughput.");
+    if (parser.has("help") || !parser.has("input")) {
+        parser.printMessage();
+        std::cout << "Available filters:";
+        for (const std::string& name : availableBatchFilters())
+            std::cout << " " << name;
+        std::cout << std::endl;
+        return parser.has("help") ? 0 : 1;
+    }
+
+    BatchOptions options;
+    options.input = parser.get<std::string>("input");
+    options.outputDir = parser.get<std::string>("output");
+    options.kernelSize = parser.get<int>("ksize") > 0 ? parser.get<int>("ksize") : defaultKernelSize;
+    options.threads = static_cast<size_t>(std::max(0, parser.get<int>("threads")));
+    if (!parser.check()) {
+        parser.printErrors();
+        return 1;
+    }
+
+    std::string filterList = parser.has("filters") ? parser.get<std::string>("filters") : defaultFilters;
+    std::stringstream names(filterList);
+    for (std::string name; std::getline(names, name, ',');) {
+        if (batchFilters().count(name) == 0) {
+            std::cerr << "Unknown filter: " << name << std::endl;
+            return 1;
+        }
+        options.filters.push_back(name);
+    }
+
+    try {
+        BatchReport report = runBatch(options);
+        printBatchReport(std::cout, report);
+        return report.failed == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        // cv::Exception, or a std::filesystem::filesystem_error while listing the input
+        std::cerr << "Batch run failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "async_image_writer.h"
+#include "batch_inputs.h"
+
+// Settings of a headless batch run
+struct BatchOptions {
+    std::string input;                 // Directory or glob pattern, e.g. "frames/*.jpg"
+    std::vector<std::string> filters;  // Names from availableBatchFilters()
+    int kernelSize = 9;
+    std::string outputDir;             // Results are discarded when empty
+    size_t threads = 0;                // 0 = one worker per core
+};
+
+// Throughput and latency of a batch run
+struct BatchReport {
+    size_t images = 0;
+    size_t failed = 0;         // Not readable, or a result could not be written
+    double seconds = 0;
+    double megapixels = 0;     // Input pixels processed (per filter)
+    double latencyP50Ms = 0;   // Per image: decode + all filters; the encoding runs asynchronously
+    double latencyP99Ms = 0;
+    std::map<std::string, ImageFormatStats> output;  // Encoding of the results, when written
+};
+
+// Names accepted in BatchOptions::filters
+std::vector<std::string> availableBatchFilters();
+
+// Runs the filters over every input image on a worker pool, without opening any window
+BatchReport runBatch(const BatchOptions& options);
+
+void printBatchReport(std::ostream& os, const BatchReport& report);
+
+// Entry point shared by the 4_filters examples: parses the command line
+// (--input, --filters, --ksize, --output, --threads), runs the batch and prints the report.
+// defaultFilters is the comma separated filter set of the calling example.
+int runBatchFromCommandLine(int argc, char** argv, const std::string& defaultFilters, int defaultKernelSize);
@@ -0,0 +1,67 @@
+#include "edge_engine.h"
+
+void EdgeEngine::compute(const cv::Mat& image, int laplacianKsize) {
+    CV_Assert(!image.empty() && image.depth() == CV_8U);
+    CV_Assert(laplacianKsize == 1 || laplacianKsize == 3);
+    const bool laplacian3 = laplacianKsize == 3;
+    if (image.channels() == 1)
+        gray = image;
+    else
+        cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+
+    // The same border as the OpenCV filters (BORDER_DEFAULT)
+    cv::copyMakeBorder(gray, padded, 1, 1, 1, 1, cv::BORDER_REFLECT_101);
+    gradX.create(gray.size(), CV_16S);
+    gradY.create(gray.size(), CV_16S);
+    gradXY.create(gray.size(), CV_16S);
+    laplace.create(gray.size(), CV_16S);
+
+    const int cols = gray.cols;
+    cv::parallel_for_(cv::Range(0, gray.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            // Rows above, at and below y; the pixel x of the image is at x + 1
+            const uchar* above = padded.ptr<uchar>(y);
+            const uchar* center = padded.ptr<uchar>(y + 1);
+            const uchar* below = padded.ptr<uchar>(y + 2);
+            short* dxRow = gradX.ptr<short>(y);
+            short* dyRow = gradY.ptr<short>(y);
+            short* dxyRow = gradXY.ptr<short>(y);
+            short* lapRow = laplace.ptr<short>(y);
+
+            for (int x = 0; x < cols; ++x) {
+                int tl = above[x], t = above[x + 1], tr = above[x + 2];
+                int l = center[x], c = center[x + 1], r = center[x + 2];
+                int bl = below[x], b = below[x + 1], br = below[x + 2];
+
+                // Sobel kernels [-1 0 1] x [1 2 1] and their transposes, the mixed derivative [-1 0 1] x [-1 0 1]
+                dxRow[x] = static_cast<short>((tr + 2 * r + br) - (tl + 2 * l + bl));
+                dyRow[x] = static_cast<short>((bl + 2 * b + br) - (tl + 2 * t + tr));
+                dxyRow[x] = static_cast<short>((tl + br) - (tr + bl));
+                // Aperture 3 is the sum of the second Sobel derivatives d²/dx² + d²/dy²
+                lapRow[x] = static_cast<short>(laplacian3 ? 2 * (tl + tr + bl + br) - 8 * c : t + l + r + b - 4 * c);
+            }
+        }
+    });
+}
+
+void EdgeEngine::magnitude(cv::Mat& dst, bool L2gradient) const {
+    cv::Mat fx, fy;
+    gradX.convertTo(fx, CV_32F);
+    gradY.convertTo(fy, CV_32F);
+    if (L2gradient)
+        cv::magnitude(fx, fy, dst);
+    else
+        dst = cv::abs(fx) + cv::abs(fy);
+}
+
+void EdgeEngine::orientation(cv::Mat& dst, bool angleInDegrees) const {
+    cv::Mat fx, fy;
+    gradX.convertTo(fx, CV_32F);
+    gradY.convertTo(fy, CV_32F);
+    cv::phase(fx, fy, dst, angleInDegrees);
+}
+
+void EdgeEngine::canny(cv::Mat& edges, double lowThreshold, double highThreshold, bool L2gradient) const {
+    // This overload takes the derivatives instead of the image, so no filtering is repeated
+    cv::Canny(gradX, gradY, edges, lowThreshold, highThreshold, L2gradient);
+}
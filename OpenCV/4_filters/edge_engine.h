@@ -0,0 +1,33 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Runs several edge detectors on the same image for the price of one. A single sweep over the 3x3 neighbourhoods
+// of the image computes the Sobel derivatives dx, dy and dxy and the Laplacian (aperture 1) together in CV_16S,
+// which holds them exactly for 8-bit images. Magnitude, orientation and Canny are derived from these buffers;
+// Canny only adds its non-maximum suppression and hysteresis instead of filtering the image again.
+// The buffers equal cv::Sobel(gray, d, CV_16S, ...) with ksize 3 and cv::Laplacian(gray, l, CV_16S, ksize) with
+// ksize 1 or 3 (default border, BORDER_REFLECT_101). canny() equals cv::Canny(dx, dy, edges, low, high); that is
+// cv::Canny(gray, edges, low, high) except in the outermost pixel rows and columns, where the Sobel inside cv::Canny
+// replicates the border instead of reflecting it.
+class EdgeEngine {
+public:
+    // Computes the derivatives of an 8-bit image; color images are converted to gray first.
+    // laplacianKsize selects the Laplacian aperture: 1 ([0 1 0; 1 -4 1; 0 1 0]) or 3 ([2 0 2; 0 -8 0; 2 0 2])
+    void compute(const cv::Mat& image, int laplacianKsize = 1);
+
+    const cv::Mat& dx() const { return gradX; }
+    const cv::Mat& dy() const { return gradY; }
+    const cv::Mat& dxy() const { return gradXY; }
+    const cv::Mat& laplacian() const { return laplace; }
+
+    // Gradient magnitude, |dx| + |dy| or sqrt(dx² + dy²), as CV_32F
+    void magnitude(cv::Mat& dst, bool L2gradient = false) const;
+    // Gradient direction as CV_32F, in degrees or radians
+    void orientation(cv::Mat& dst, bool angleInDegrees = true) const;
+    // Canny edges from the shared gradients
+    void canny(cv::Mat& edges, double lowThreshold, double highThreshold, bool L2gradient = false) const;
+
+private:
+    cv::Mat gray, padded;
+    cv::Mat gradX, gradY, gradXY, laplace;
+};
@@ -0,0 +1,211 @@
+#include "fast_morphology.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// Below this width + height OpenCV's own vectorized morphology is faster
+static const int fastMinExtent = 14;
+
+struct ErodeOp {
+    static uchar apply(uchar a, uchar b) { return std::min(a, b); }
+    static constexpr uchar identity = 255;
+};
+
+struct DilateOp {
+    static uchar apply(uchar a, uchar b) { return std::max(a, b); }
+    static constexpr uchar identity = 0;
+};
+
+// Rows of an image that are available to a pass: `rows` holds the image rows [first, first + rows.rows).
+// Rows above and below the image are the identity of the operation, so they never win (OpenCV's default border).
+struct RowWindow {
+    cv::Mat rows;
+    int first;
+    int imageRows;
+};
+
+template<class Op>
+static void combineRows(const uchar* a, const uchar* b, uchar* out, int width) {
+    for (int i = 0; i < width; ++i)
+        out[i] = Op::apply(a[i], b[i]);
+}
+
+// 1-D pass along one row with a window of w pixels; channels are interleaved and handled side by side
+template<class Op>
+static void horizontalPass(const uchar* src, uchar* dst, int cols, int channels, int w, int anchorX,
+                           std::vector<uchar>& padded, std::vector<uchar>& prefix, std::vector<uchar>& suffix) {
+    // Element j of the padded row is the pixel x = j - anchorX
+    const int n = cols + w - 1;
+    padded.assign(static_cast<size_t>(n) * channels, Op::identity);
+    std::copy(src, src + cols * channels, padded.begin() + anchorX * channels);
+    prefix.resize(padded.size());
+    suffix.resize(padded.size());
+    const uchar* p = padded.data();
+    uchar* g = prefix.data();
+    uchar* h = suffix.data();
+
+    // Extrema from the start of every block of w pixels, and to its end
+    for (int j = 0; j < n; ++j)
+        for (int c = 0; c < channels; ++c) {
+            int i = j * channels + c;
+            g[i] = j % w == 0 ? p[i] : Op::apply(g[i - channels], p[i]);
+        }
+    for (int j = n - 1; j >= 0; --j)
+        for (int c = 0; c < channels; ++c) {
+            int i = j * channels + c;
+            h[i] = (j % w == w - 1 || j == n - 1) ? p[i] : Op::apply(h[i + channels], p[i]);
+        }
+
+    // The window [x, x + w) covers the end of one block and the start of the next
+    combineRows<Op>(h, g + (w - 1) * channels, dst, cols * channels);
+}
+
+// Computes the rows [y0, y1) of the erosion/dilation of the image in `in` with a w x h rectangle
+template<class Op>
+static void morphBand(const RowWindow& in, int y0, int y1, cv::Size ksize, cv::Point anchor, cv::Mat& out) {
+    const int cols = in.rows.cols, channels = in.rows.channels();
+    const int width = cols * channels;
+    const int count = y1 - y0;
+    const int h = ksize.height;
+    const int n = count + h - 1;  // Rows read by the column pass
+
+    // Row pass over every row the column pass needs
+    cv::Mat horizontal(n, width, CV_8U);
+    std::vector<uchar> padded, prefix, suffix;
+    for (int j = 0; j < n; ++j) {
+        int y = y0 - anchor.y + j;
+        uchar* row = horizontal.ptr<uchar>(j);
+        if (y < 0 || y >= in.imageRows) {
+            std::fill(row, row + width, Op::identity);
+            continue;
+        }
+        CV_Assert(y >= in.first && y < in.first + in.rows.rows);
+        const uchar* src = in.rows.ptr<uchar>(y - in.first);
+        if (ksize.width == 1)
+            std::copy(src, src + width, row);
+        else
+            horizontalPass<Op>(src, row, cols, channels, ksize.width, anchor.x, padded, prefix, suffix);
+    }
+
+    if (h == 1) {
+        for (int i = 0; i < count; ++i)
+            std::copy(horizontal.ptr<uchar>(i), horizontal.ptr<uchar>(i) + width, out.ptr<uchar>(i));
+        return;
+    }
+
+    // Column pass, one block of h rows at a time: suffix rows of this block, prefix rows of the next one
+    cv::Mat suffixRows(h, width, CV_8U), prefixRows(h, width, CV_8U);
+    for (int i0 = 0; i0 < count; i0 += h) {
+        std::copy(horizontal.ptr<uchar>(i0 + h - 1), horizontal.ptr<uchar>(i0 + h - 1) + width,
+                  suffixRows.ptr<uchar>(h - 1));
+        for (int j = h - 2; j >= 0; --j)
+            combineRows<Op>(suffixRows.ptr<uchar>(j + 1), horizontal.ptr<uchar>(i0 + j), suffixRows.ptr<uchar>(j), width);
+
+        int prefixCount = std::min(h - 1, n - (i0 + h));
+        for (int j = 0; j < prefixCount; ++j) {
+            const uchar* row = horizontal.ptr<uchar>(i0 + h + j);
+            if (j == 0)
+                std::copy(row, row + width, prefixRows.ptr<uchar>(0));
+            else
+                combineRows<Op>(prefixRows.ptr<uchar>(j - 1), row, prefixRows.ptr<uchar>(j), width);
+        }
+
+        for (int i = i0; i < std::min(i0 + h, count); ++i) {
+            const uchar* suffix = suffixRows.ptr<uchar>(i - i0);
+            if (i == i0)
+                std::copy(suffix, suffix + width, out.ptr<uchar>(i));  // The window is exactly this block
+            else
+                combineRows<Op>(suffix, prefixRows.ptr<uchar>(i - i0 - 1), out.ptr<uchar>(i), width);
+        }
+    }
+}
+
+// Rows [y0, y1) of First followed by Second; only the rows of the first pass that the second one reads are computed
+template<class First, class Second>
+static void compositeBand(const cv::Mat& src, int y0, int y1, cv::Size ksize, cv::Point anchor, cv::Mat& out) {
+    int a0 = std::max(0, y0 - anchor.y);
+    int a1 = std::min(src.rows, y1 + ksize.height - 1 - anchor.y);
+    cv::Mat first(a1 - a0, src.cols, src.type());
+    morphBand<First>(RowWindow{src, 0, src.rows}, a0, a1, ksize, anchor, first);
+    morphBand<Second>(RowWindow{first, a0, src.rows}, y0, y1, ksize, anchor, out);
+}
+
+static bool isFastRect(const cv::Mat& src, const cv::Mat& element) {
+    if (src.depth() != CV_8U || element.empty() || element.cols + element.rows < fastMinExtent)
+        return false;
+    return cv::countNonZero(element) == static_cast<int>(element.total());
+}
+
+void fastErode(const cv::Mat& src, cv::Mat& dst, const cv::Mat& element, cv::Point anchor) {
+    fastMorphologyEx(src, dst, cv::MORPH_ERODE, element, anchor);
+}
+
+void fastDilate(const cv::Mat& src, cv::Mat& dst, const cv::Mat& element, cv::Point anchor) {
+    fastMorphologyEx(src, dst, cv::MORPH_DILATE, element, anchor);
+}
+
+void fastMorphologyEx(const cv::Mat& src, cv::Mat& dst, int op, const cv::Mat& element, cv::Point anchor) {
+    bool supported = op == cv::MORPH_ERODE || op == cv::MORPH_DILATE || op == cv::MORPH_OPEN ||
+                     op == cv::MORPH_CLOSE || op == cv::MORPH_GRADIENT || op == cv::MORPH_TOPHAT ||
+                     op == cv::MORPH_BLACKHAT;
+    if (!supported || !isFastRect(src, element)) {
+        cv::morphologyEx(src, dst, op, element, anchor);
+        return;
+    }
+
+    const cv::Size ksize = element.size();
+    if (anchor.x < 0)
+        anchor.x = ksize.width / 2;
+    if (anchor.y < 0)
+        anchor.y = ksize.height / 2;
+
+    // Bands read rows of their neighbours, so the output must not overwrite the input
+    cv::Mat source = src;
+    if (dst.data && dst.datastart == source.datastart)
+        source = src.clone();
+    dst.create(source.size(), source.type());
+
+    // Every band recomputes the rows of the first pass around it, so bands have to be tall compared to the element
+    const int threads = std::max(1, cv::getNumThreads());
+    const int bandRows = std::max(4 * ksize.height, (source.rows + threads - 1) / threads);
+    const int bands = (source.rows + bandRows - 1) / bandRows;
+
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+        for (int band = range.start; band < range.end; ++band) {
+            int y0 = band * bandRows;
+            int y1 = std::min(source.rows, y0 + bandRows);
+            cv::Mat out = dst.rowRange(y0, y1);
+            const RowWindow whole{source, 0, source.rows};
+
+            switch (op) {
+                case cv::MORPH_ERODE:
+                    morphBand<ErodeOp>(whole, y0, y1, ksize, anchor, out);
+                    break;
+                case cv::MORPH_DILATE:
+                    morphBand<DilateOp>(whole, y0, y1, ksize, anchor, out);
+                    break;
+                case cv::MORPH_OPEN:
+                    compositeBand<ErodeOp, DilateOp>(source, y0, y1, ksize, anchor, out);
+                    break;
+                case cv::MORPH_CLOSE:
+                    compositeBand<DilateOp, ErodeOp>(source, y0, y1, ksize, anchor, out);
+                    break;
+                case cv::MORPH_GRADIENT: {
+                    cv::Mat eroded(y1 - y0, source.cols, source.type());
+                    morphBand<ErodeOp>(whole, y0, y1, ksize, anchor, eroded);
+                    morphBand<DilateOp>(whole, y0, y1, ksize, anchor, out);
+                    cv::subtract(out, eroded, out);
+                    break;
+                }
+                case cv::MORPH_TOPHAT:
+                    compositeBand<ErodeOp, DilateOp>(source, y0, y1, ksize, anchor, out);
+                    cv::subtract(source.rowRange(y0, y1), out, out);
+                    break;
+                case cv::MORPH_BLACKHAT:
+                    compositeBand<DilateOp, ErodeOp>(source, y0, y1, ksize, anchor, out);
+                    cv::subtract(out, source.rowRange(y0, y1), out);
+                    break;
+            }
+        }
+    });
+}
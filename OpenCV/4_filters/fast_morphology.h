@@ -0,0 +1,18 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Erosion, dilation and the morphologyEx composites for large rectangular structuring elements (including
+// horizontal and vertical lines, which are rectangles of height or width 1).
+// A rectangle is separable: the minimum/maximum over w x h is a 1-D pass along the rows followed by one along
+// the columns. Each 1-D pass uses the van Herk / Gil-Werman algorithm: the line is cut into blocks of the window
+// length, prefix and suffix extrema are taken inside every block, and the extremum of any window is the combination
+// of one suffix and one prefix value. That is about 3 comparisons per pixel and pass, whatever the element size.
+// The column pass combines whole rows, which the compiler vectorizes; horizontal bands run in parallel. Open, close,
+// gradient, top hat and black hat are computed band by band, so no full-size intermediate image is created.
+// Results are identical to cv::erode / cv::dilate / cv::morphologyEx with the default border, one iteration.
+// 8-bit images with any number of channels; other element shapes, small elements and other depths are passed
+// to OpenCV.
+void fastErode(const cv::Mat& src, cv::Mat& dst, const cv::Mat& element, cv::Point anchor = cv::Point(-1, -1));
+void fastDilate(const cv::Mat& src, cv::Mat& dst, const cv::Mat& element, cv::Point anchor = cv::Point(-1, -1));
+void fastMorphologyEx(const cv::Mat& src, cv::Mat& dst, int op, const cv::Mat& element,
+                      cv::Point anchor = cv::Point(-1, -1));
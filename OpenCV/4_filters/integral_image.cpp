@@ -0,0 +1,180 @@
+#include "integral_image.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// Bands shorter than this cost more in carries than they gain in parallelism
+static const int minBandRows = 64;
+
+// Integrates the padded rows of one band as if the band started at the top of the image.
+// Table row y + 1 holds the sums of the padded rows up to and including y.
+template<typename T, bool Squared>
+static void integrateBand(const cv::Mat& padded, cv::Mat& table, const cv::Range& band) {
+    const int cn = padded.channels();
+    const int width = padded.cols * cn;
+    for (int y = band.start; y < band.end; ++y) {
+        const uchar* p = padded.ptr<uchar>(y);
+        const T* above = y == band.start ? nullptr : table.ptr<T>(y);
+        T* row = table.ptr<T>(y + 1);
+        T running[4] = {0, 0, 0, 0};
+        std::fill(row, row + cn, T(0));
+        for (int i = 0; i < width; i += cn) {
+            for (int c = 0; c < cn; ++c) {
+                const T value = p[i + c];
+                running[c] += Squared ? value * value : value;
+                row[cn + i + c] = above ? above[cn + i + c] + running[c] : running[c];
+            }
+        }
+    }
+}
+
+// Adds the totals of all bands above to every row of a band
+template<typename T, bool Squared>
+static void buildTable(const cv::Mat& padded, cv::Mat& table) {
+    const int width = table.cols * table.channels();
+    std::memset(table.ptr(0), 0, width * sizeof(T));
+
+    const int threads = std::max(1, cv::getNumThreads());
+    const int bandRows = std::max(minBandRows, (padded.rows + threads - 1) / threads);
+    std::vector<cv::Range> bands;
+    for (int y0 = 0; y0 < padded.rows; y0 += bandRows)
+        bands.emplace_back(y0, std::min(padded.rows, y0 + bandRows));
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(bands.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i)
+            integrateBand<T, Squared>(padded, table, bands[i]);
+    });
+
+    // Carry of band k = sum of the last rows of bands 0 .. k - 1; a single row per band, so this part is cheap
+    std::vector<std::vector<T>> carries(bands.size(), std::vector<T>(width, T(0)));
+    for (size_t k = 1; k < bands.size(); ++k) {
+        const T* last = table.ptr<T>(bands[k - 1].end);
+        for (int i = 0; i < width; ++i)
+            carries[k][i] = carries[k - 1][i] + last[i];
+    }
+
+    cv::parallel_for_(cv::Range(1, static_cast<int>(bands.size())), [&](const cv::Range& range) {
+        for (int k = range.start; k < range.end; ++k) {
+            const T* carry = carries[k].data();
+            for (int y = bands[k].start; y < bands[k].end; ++y) {
+                T* row = table.ptr<T>(y + 1);
+                for (int i = 0; i < width; ++i)
+                    row[i] += carry[i];
+            }
+        }
+    });
+}
+
+void IntegralImage::build(const cv::Mat& image, int maxRadius, bool withSquares) {
+    CV_Assert(!image.empty() && image.depth() == CV_8U && image.channels() <= 4);
+    // BORDER_REFLECT_101 can only mirror what is there
+    CV_Assert(maxRadius >= 0 && maxRadius < std::min(image.rows, image.cols));
+    imageSize = image.size();
+    cn = image.channels();
+    radius = maxRadius;
+
+    cv::Mat padded = image;
+    if (radius > 0)
+        cv::copyMakeBorder(image, padded, radius, radius, radius, radius, cv::BORDER_REFLECT_101);
+
+    sums.create(padded.rows + 1, padded.cols + 1, CV_32SC(cn));
+    buildTable<uint32_t, false>(padded, sums);
+    if (withSquares) {
+        squares.create(padded.rows + 1, padded.cols + 1, CV_64FC(cn));
+        buildTable<double, true>(padded, squares);
+    } else {
+        squares.release();
+    }
+}
+
+double IntegralImage::sum(const cv::Rect& box, int channel) const {
+    CV_Assert(!sums.empty() && channel >= 0 && channel < cn);
+    CV_Assert(box.x >= -radius && box.y >= -radius && box.width >= 0 && box.height >= 0 &&
+              box.x + box.width <= imageSize.width + radius && box.y + box.height <= imageSize.height + radius);
+    const int x0 = (box.x + radius) * cn + channel, x1 = x0 + box.width * cn;
+    const uint32_t* t0 = sums.ptr<uint32_t>(box.y + radius);
+    const uint32_t* t1 = sums.ptr<uint32_t>(box.y + radius + box.height);
+    return static_cast<uint32_t>(t1[x1] - t0[x1] - t1[x0] + t0[x0]);
+}
+
+double IntegralImage::mean(const cv::Rect& box, int channel) const {
+    return box.area() > 0 ? sum(box, channel) / box.area() : 0.0;
+}
+
+double IntegralImage::variance(const cv::Rect& box, int channel) const {
+    CV_Assert(!squares.empty());
+    if (box.area() <= 0)
+        return 0.0;
+    const double m = mean(box, channel);
+    const int x0 = (box.x + radius) * cn + channel, x1 = x0 + box.width * cn;
+    const double* q0 = squares.ptr<double>(box.y + radius);
+    const double* q1 = squares.ptr<double>(box.y + radius + box.height);
+    const double squaredSum = q1[x1] - q0[x1] - q1[x0] + q0[x0];
+    return std::max(0.0, squaredSum / box.area() - m * m);
+}
+
+void IntegralImage::checkBox(const cv::Size& ksize) const {
+    CV_Assert(!sums.empty() && ksize.width > 0 && ksize.height > 0);
+    // The box spans [x - k / 2, x - k / 2 + k) like the OpenCV filters with the default anchor
+    CV_Assert(ksize.width / 2 <= radius && ksize.width - ksize.width / 2 - 1 <= radius);
+    CV_Assert(ksize.height / 2 <= radius && ksize.height - ksize.height / 2 - 1 <= radius);
+}
+
+void IntegralImage::boxMean(cv::Mat& dst, cv::Size ksize) const {
+    checkBox(ksize);
+    dst.create(imageSize, CV_8UC(cn));
+    const float scale = 1.f / (ksize.width * ksize.height);
+    // Table column of the left and right box edge relative to the output value
+    const int left = (radius - ksize.width / 2) * cn, right = left + ksize.width * cn;
+    const int width = imageSize.width * cn;
+
+    cv::parallel_for_(cv::Range(0, imageSize.height), [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y) {
+            const int top = y + radius - ksize.height / 2;
+            const uint32_t* t0 = sums.ptr<uint32_t>(top);
+            const uint32_t* t1 = sums.ptr<uint32_t>(top + ksize.height);
+            uchar* out = dst.ptr<uchar>(y);
+            // Four contiguous table rows, no dependency between outputs: the compiler vectorizes this loop
+            for (int i = 0; i < width; ++i) {
+                const uint32_t s = t1[i + right] - t0[i + right] - t1[i + left] + t0[i + left];
+                out[i] = cv::saturate_cast<uchar>(s * scale);
+            }
+        }
+    });
+}
+
+void IntegralImage::localMeanVariance(cv::Mat& mean, cv::Mat& variance, cv::Size ksize) const {
+    checkBox(ksize);
+    CV_Assert(!squares.empty());
+    mean.create(imageSize, CV_32FC(cn));
+    variance.create(imageSize, CV_32FC(cn));
+    const double scale = 1.0 / (ksize.width * ksize.height);
+    const int left = (radius - ksize.width / 2) * cn, right = left + ksize.width * cn;
+    const int width = imageSize.width * cn;
+
+    cv::parallel_for_(cv::Range(0, imageSize.height), [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y) {
+            const int top = y + radius - ksize.height / 2;
+            const uint32_t* t0 = sums.ptr<uint32_t>(top);
+            const uint32_t* t1 = sums.ptr<uint32_t>(top + ksize.height);
+            const double* q0 = squares.ptr<double>(top);
+            const double* q1 = squares.ptr<double>(top + ksize.height);
+            float* m = mean.ptr<float>(y);
+            float* v = variance.ptr<float>(y);
+            for (int i = 0; i < width; ++i) {
+                const double s = static_cast<uint32_t>(t1[i + right] - t0[i + right] - t1[i + left] + t0[i + left]);
+                const double q = q1[i + right] - q0[i + right] - q1[i + left] + q0[i + left];
+                const double boxMean = s * scale;
+                m[i] = static_cast<float>(boxMean);
+                v[i] = static_cast<float>(std::max(0.0, q * scale - boxMean * boxMean));
+            }
+        }
+    });
+}
+
+std::vector<cv::Mat> IntegralImage::boxMeans(const std::vector<cv::Size>& ksizes) const {
+    std::vector<cv::Mat> means(ksizes.size());
+    for (size_t i = 0; i < ksizes.size(); ++i)
+        boxMean(means[i], ksizes[i]);
+    return means;
+}
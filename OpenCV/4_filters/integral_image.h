@@ -0,0 +1,48 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Sum and squared-sum tables of one 8-bit frame (1 to 4 channels), built once and then queried for any number of
+// box sizes: the sum over any rectangle is 4 table lookups, whatever its size.
+// The tables are built by horizontal bands in parallel: every band is integrated on its own, then the last row of
+// each band is carried into the bands below it.
+// Sums are kept as 32-bit unsigned integers; box sums are differences, which stay exact modulo 2^32 as long as a box
+// holds fewer than 2^32 / 255 (16 million) pixels. Squared sums are doubles, exact up to 2^53.
+class IntegralImage {
+public:
+    IntegralImage() = default;
+    explicit IntegralImage(const cv::Mat& image, int maxRadius = 0, bool squares = true) {
+        build(image, maxRadius, squares);
+    }
+
+    // The image is extended by maxRadius pixels with BORDER_REFLECT_101, the default border of cv::blur, so boxes
+    // reaching up to maxRadius beyond the image see the same pixels as the OpenCV filters.
+    // squares = false skips the squared-sum table when no variances are needed.
+    void build(const cv::Mat& image, int maxRadius = 0, bool squares = true);
+
+    cv::Size size() const { return imageSize; }
+    int channels() const { return cn; }
+    int maxRadius() const { return radius; }
+
+    // Statistics of a rectangle in image coordinates (it may reach maxRadius outside the image)
+    double sum(const cv::Rect& box, int channel = 0) const;
+    double mean(const cv::Rect& box, int channel = 0) const;
+    double variance(const cv::Rect& box, int channel = 0) const;
+
+    // Mean of the ksize box around every pixel (anchor at the center), same as cv::blur(image, dst, ksize) up to
+    // the rounding of exact halves; dst has the type of the image. ksize / 2 must not exceed maxRadius.
+    void boxMean(cv::Mat& dst, cv::Size ksize) const;
+    // Local mean and variance in the ksize box around every pixel, CV_32F with the channels of the image
+    void localMeanVariance(cv::Mat& mean, cv::Mat& variance, cv::Size ksize) const;
+    // Box means of several sizes from the same tables, e.g. for multi-scale focus measures
+    std::vector<cv::Mat> boxMeans(const std::vector<cv::Size>& ksizes) const;
+
+private:
+    void checkBox(const cv::Size& ksize) const;
+
+    cv::Size imageSize;
+    int cn = 0;
+    int radius = 0;
+    cv::Mat sums;     // (rows + 2 radius + 1) x (cols + 2 radius + 1), CV_32S holding uint32 values
+    cv::Mat squares;  // Same layout, CV_64F
+};
@@ -0,0 +1,217 @@
+#include "kernel_engine.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <utility>
+
+const char* kernelPathName(KernelPath path) {
+    switch (path) {
+        case KernelPath::Direct:
+            return "direct";
+        case KernelPath::Separable:
+            return "separable";
+        case KernelPath::FixedPoint:
+            return "fixed-point";
+        case KernelPath::Dft:
+            return "dft";
+    }
+    return "unknown";
+}
+
+// Scales the kernel by 2^bits; succeeds if every coefficient becomes an integer and the sum over a 255-valued
+// neighbourhood still fits into an int
+static bool quantizeKernel(const cv::Mat& kernel, int bits, std::vector<int>& weights) {
+    const double scale = 1 << bits;
+    double range = 0;
+    weights.clear();
+    for (int y = 0; y < kernel.rows; ++y) {
+        for (int x = 0; x < kernel.cols; ++x) {
+            double value = kernel.at<double>(y, x) * scale;
+            double rounded = std::round(value);
+            if (std::abs(value - rounded) > 1e-6)
+                return false;
+            weights.push_back(static_cast<int>(rounded));
+            range += std::abs(rounded);
+        }
+    }
+    return range * 255 < INT_MAX;
+}
+
+int CustomKernelFilter::defaultDftCost(int depth) {
+    // Same condition as cv::filter2D: its spatial filter is vectorized for these depths
+    const bool fastSpatial = cv::checkHardwareSupport(CV_CPU_SSE3) && (depth == CV_8U || depth == CV_32F);
+    return fastSpatial ? 130 : 50;
+}
+
+CustomKernelFilter::CustomKernelFilter(const cv::Mat& userKernel, int dftCost) : dftCost(dftCost) {
+    CV_Assert(!userKernel.empty() && userKernel.channels() == 1);
+    userKernel.convertTo(kernel, CV_32F);
+    anchor = cv::Point(kernel.cols / 2, kernel.rows / 2);
+
+    cv::Mat kernel64;
+    kernel.convertTo(kernel64, CV_64F);
+
+    // kernel = sum of w_i * u_i * v_i^T; every term with a significant singular value is one separable pass
+    cv::Mat w, u, vt;
+    cv::SVD::compute(kernel64, w, u, vt);
+    const double largest = w.at<double>(0);
+    for (int i = 0; i < w.rows; ++i) {
+        double singularValue = w.at<double>(i);
+        if (singularValue <= largest * 1e-6)
+            break;
+        cv::Mat column, row;
+        cv::Mat(u.col(i) * std::sqrt(singularValue)).convertTo(column, CV_32F);
+        cv::Mat(vt.row(i) * std::sqrt(singularValue)).convertTo(row, CV_32F);
+        columnKernels.push_back(column);
+        rowKernels.push_back(row);
+    }
+
+    // Smallest power-of-two denominator that represents the coefficients exactly
+    std::vector<int> weights;
+    for (int bits = 0; bits <= 8; ++bits) {
+        if (!quantizeKernel(kernel64, bits, weights))
+            continue;
+        fixedPointBits = bits;
+        for (int y = 0; y < kernel.rows; ++y)
+            for (int x = 0; x < kernel.cols; ++x)
+                if (weights[y * kernel.cols + x] != 0)
+                    taps.push_back({y, x, weights[y * kernel.cols + x]});
+        break;
+    }
+}
+
+KernelPath CustomKernelFilter::path(int depth) const {
+    if (rowKernels.empty())
+        return KernelPath::Direct;  // All zero
+
+    // Rough cost per pixel of every path, in multiply-adds
+    int best = kernel.rows * kernel.cols;
+    KernelPath choice = KernelPath::Direct;
+    int separable = rank() * (kernel.rows + kernel.cols);
+    if (separable < best) {
+        best = separable;
+        choice = KernelPath::Separable;
+    }
+    if (depth == CV_8U && !taps.empty() && static_cast<int>(taps.size()) <= best) {
+        best = static_cast<int>(taps.size());
+        choice = KernelPath::FixedPoint;
+    }
+    // The DFT only replaces the dense 2-D correlation; a separable or fixed-point path stays in use however large
+    // the kernel is, e.g. 62 instead of 961 multiply-adds for a 31x31 Gaussian
+    const int threshold = dftCost > 0 ? dftCost : defaultDftCost(depth);
+    if (choice == KernelPath::Direct && kernel.rows * kernel.cols >= threshold)
+        return KernelPath::Dft;
+    return choice;
+}
+
+void CustomKernelFilter::apply(const cv::Mat& src, cv::Mat& dst) const {
+    switch (path(src.depth())) {
+        case KernelPath::Direct:
+            applyDirect(src, dst);
+            break;
+        case KernelPath::Separable:
+            applySeparable(src, dst);
+            break;
+        case KernelPath::FixedPoint:
+            applyFixedPoint(src, dst);
+            break;
+        case KernelPath::Dft:
+            applyDft(src, dst);
+            break;
+    }
+}
+
+void CustomKernelFilter::applyDirect(const cv::Mat& src, cv::Mat& dst) const {
+    cv::filter2D(src, dst, -1, kernel, anchor, 0, cv::BORDER_REFLECT_101);
+}
+
+void CustomKernelFilter::applySeparable(const cv::Mat& src, cv::Mat& dst) const {
+    if (rank() == 1) {
+        // A single pass can write the output depth directly (OpenCV uses integer arithmetic for 8-bit images)
+        cv::sepFilter2D(src, dst, -1, rowKernels[0], columnKernels[0], anchor, 0, cv::BORDER_REFLECT_101);
+        return;
+    }
+
+    // Several passes are summed in float and rounded once at the end
+    cv::Mat sum, term;
+    for (int i = 0; i < rank(); ++i) {
+        cv::sepFilter2D(src, term, CV_32F, rowKernels[i], columnKernels[i], anchor, 0, cv::BORDER_REFLECT_101);
+        if (i == 0)
+            std::swap(sum, term);
+        else
+            sum += term;
+    }
+    sum.convertTo(dst, src.depth());
+}
+
+void CustomKernelFilter::applyFixedPoint(const cv::Mat& src, cv::Mat& dst) const {
+    CV_Assert(src.depth() == CV_8U);
+    cv::Mat padded;
+    cv::copyMakeBorder(src, padded, anchor.y, kernel.rows - 1 - anchor.y, anchor.x, kernel.cols - 1 - anchor.x,
+                       cv::BORDER_REFLECT_101);
+    dst.create(src.size(), src.type());
+
+    // Channels are interleaved, so a tap moves by `channels` elements per pixel and the rows can be processed
+    // as flat arrays
+    const int channels = src.channels();
+    const int width = src.cols * channels;
+    const int bits = fixedPointBits;
+    const int half = bits > 0 ? 1 << (bits - 1) : 0;
+
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        std::vector<int> accumulator(width);
+        int* acc = accumulator.data();
+        for (int y = range.start; y < range.end; ++y) {
+            std::fill(accumulator.begin(), accumulator.end(), half);
+            for (const Tap& tap : taps) {
+                const uchar* s = padded.ptr<uchar>(y + tap.dy) + tap.dx * channels;
+                const int weight = tap.weight;
+                // Simple loop over contiguous memory, vectorized by the compiler
+                for (int i = 0; i < width; ++i)
+                    acc[i] += weight * s[i];
+            }
+            uchar* d = dst.ptr<uchar>(y);
+            for (int i = 0; i < width; ++i)
+                d[i] = cv::saturate_cast<uchar>(acc[i] >> bits);
+        }
+    });
+}
+
+void CustomKernelFilter::applyDft(const cv::Mat& src, cv::Mat& dst) const {
+    // With the border added, the circular correlation of the padded image does not wrap around for any output pixel
+    cv::Mat padded;
+    cv::copyMakeBorder(src, padded, anchor.y, kernel.rows - 1 - anchor.y, anchor.x, kernel.cols - 1 - anchor.x,
+                       cv::BORDER_REFLECT_101);
+    cv::Size dftSize(cv::getOptimalDFTSize(padded.cols), cv::getOptimalDFTSize(padded.rows));
+
+    cv::Mat spectrum;
+    {
+        std::lock_guard<std::mutex> lock(spectrumMutex);
+        if (kernelSpectrum.size() != dftSize) {
+            cv::Mat kernelPlane = cv::Mat::zeros(dftSize, CV_32F);
+            cv::Mat kernelArea = kernelPlane(cv::Rect(0, 0, kernel.cols, kernel.rows));
+            kernel.copyTo(kernelArea);
+            cv::Mat newSpectrum;  // Never overwrite a spectrum another call may still be using
+            cv::dft(kernelPlane, newSpectrum, 0, kernel.rows);
+            kernelSpectrum = newSpectrum;
+        }
+        spectrum = kernelSpectrum;
+    }
+
+    std::vector<cv::Mat> planes, results;
+    cv::split(padded, planes);
+    for (const cv::Mat& channel : planes) {
+        cv::Mat plane = cv::Mat::zeros(dftSize, CV_32F);
+        cv::Mat imageArea = plane(cv::Rect(0, 0, padded.cols, padded.rows));
+        channel.convertTo(imageArea, CV_32F);
+        cv::dft(plane, plane, 0, padded.rows);
+        // Correlation (what filter2D computes) is the product with the conjugated kernel spectrum
+        cv::mulSpectrums(plane, spectrum, plane, 0, true);
+        cv::idft(plane, plane, cv::DFT_SCALE, src.rows);
+        results.push_back(plane(cv::Rect(0, 0, src.cols, src.rows)));
+    }
+
+    cv::Mat merged;
+    cv::merge(results, merged);
+    merged.convertTo(dst, src.depth());
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <mutex>
+#include <vector>
+
+// Ways CustomKernelFilter can apply a kernel
+enum class KernelPath {
+    Direct,      // cv::filter2D
+    Separable,   // Sum of rank-1 row/column passes (cv::sepFilter2D)
+    FixedPoint,  // Integer multiply-accumulate over the non-zero taps, 8-bit images only
+    Dft          // Correlation in the frequency domain
+};
+
+const char* kernelPathName(KernelPath path);
+
+// Drop-in replacement for cv::filter2D(src, dst, -1, kernel) (centered anchor, BORDER_REFLECT_101) for kernels
+// that are applied to many images. The kernel is analysed once:
+// * its SVD gives the rank r, so it can run as r separable passes costing r * (w + h) instead of w * h per pixel,
+// * coefficients that are integers (or multiples of 1/2^n, n <= 8) allow integer arithmetic on 8-bit images,
+//   touching only the non-zero taps,
+// * large dense kernels are applied through the DFT, whose cost does not depend on the kernel size.
+// apply() picks the cheapest of these for the depth of the image. All paths give the result of cv::filter2D up to
+// rounding. apply() may be called from several threads at once.
+class CustomKernelFilter {
+public:
+    // Kernel size (coefficients) from which cv::filter2D switches to the DFT for images of the given depth
+    // (dftFilter2D in OpenCV's filter.dispatch.cpp): 130 for 8-bit and float images on SSE3 hardware, 50 otherwise
+    static int defaultDftCost(int depth);
+
+    // dftCost: kernel size from which a dense kernel, one without a cheaper separable or fixed-point path, is applied
+    // through the DFT; 0 takes defaultDftCost() of the filtered image. The crossover depends on the CPU and the image
+    // size, so a value measured for the target can be passed here.
+    explicit CustomKernelFilter(const cv::Mat& kernel, int dftCost = 0);
+
+    void apply(const cv::Mat& src, cv::Mat& dst) const;
+
+    // Path apply() takes for images of the given depth
+    KernelPath path(int depth) const;
+    int rank() const { return static_cast<int>(rowKernels.size()); }
+
+private:
+    struct Tap {
+        int dy, dx;  // Position in the kernel
+        int weight;  // Coefficient * 2^fixedPointBits
+    };
+
+    void applyDirect(const cv::Mat& src, cv::Mat& dst) const;
+    void applySeparable(const cv::Mat& src, cv::Mat& dst) const;
+    void applyFixedPoint(const cv::Mat& src, cv::Mat& dst) const;
+    void applyDft(const cv::Mat& src, cv::Mat& dst) const;
+
+    cv::Mat kernel;  // CV_32F
+    cv::Point anchor;
+    int dftCost;
+
+    std::vector<cv::Mat> rowKernels, columnKernels;  // Rank-1 terms of the SVD
+    std::vector<Tap> taps;                           // Empty if the coefficients are not fixed-point numbers
+    int fixedPointBits = 0;
+
+    // Spectrum of the kernel for the last DFT size, shared by all calls
+    mutable std::mutex spectrumMutex;
+    mutable cv::Mat kernelSpectrum;
+};
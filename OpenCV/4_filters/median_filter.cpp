@@ -0,0 +1,125 @@
+#include "median_filter.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Below this aperture the sorting networks of cv::medianBlur are faster
+static const int constantTimeMinKernel = 7;
+
+// Histogram of the values of one channel: coarse bins count the high nibble, fine bins the full value
+struct MedianHistogram {
+    uint16_t coarse[16];
+    uint16_t fine[16][16];
+};
+
+static void addValue(MedianHistogram& histogram, uchar value) {
+    ++histogram.coarse[value >> 4];
+    ++histogram.fine[value >> 4][value & 15];
+}
+
+static void removeValue(MedianHistogram& histogram, uchar value) {
+    --histogram.coarse[value >> 4];
+    --histogram.fine[value >> 4][value & 15];
+}
+
+// Filters the output rows [y0, y1) from the replicated-border image `padded`
+static void medianBand(const cv::Mat& padded, cv::Mat& dst, int ksize, int y0, int y1) {
+    const int channels = dst.channels();
+    const int radius = ksize / 2;
+    const int target = ksize * ksize / 2;  // Rank of the median in the window
+    const int values = padded.cols * channels;
+
+    // One histogram per padded column and channel, in the interleaved order of the row values
+    std::vector<MedianHistogram> columns(values);
+    std::memset(columns.data(), 0, columns.size() * sizeof(MedianHistogram));
+    for (int row = y0; row < y0 + ksize; ++row) {
+        const uchar* p = padded.ptr<uchar>(row);
+        for (int i = 0; i < values; ++i)
+            addValue(columns[i], p[i]);
+    }
+
+    for (int y = y0; y < y1; ++y) {
+        if (y > y0) {
+            // Slide the column histograms one row down
+            const uchar* leaving = padded.ptr<uchar>(y - 1);
+            const uchar* entering = padded.ptr<uchar>(y + 2 * radius);
+            for (int i = 0; i < values; ++i) {
+                removeValue(columns[i], leaving[i]);
+                addValue(columns[i], entering[i]);
+            }
+        }
+
+        uchar* out = dst.ptr<uchar>(y);
+        for (int c = 0; c < channels; ++c) {
+            auto column = [&](int x) -> const MedianHistogram& { return columns[x * channels + c]; };
+
+            MedianHistogram kernel;
+            std::memset(&kernel, 0, sizeof(kernel));
+            int fineEnd[16] = {};  // Fine bins of coarse bin b hold the columns [fineEnd[b] - ksize, fineEnd[b])
+            for (int x = 0; x < ksize; ++x)
+                for (int b = 0; b < 16; ++b)
+                    kernel.coarse[b] += column(x).coarse[b];
+
+            for (int x = 0; x < dst.cols; ++x) {
+                if (x > 0) {
+                    const MedianHistogram& entering = column(x + 2 * radius);
+                    const MedianHistogram& leaving = column(x - 1);
+                    for (int b = 0; b < 16; ++b)
+                        kernel.coarse[b] += entering.coarse[b] - leaving.coarse[b];
+                }
+
+                // Coarse bin that contains the median
+                int bin = 0, count = 0;
+                while (count + kernel.coarse[bin] <= target)
+                    count += kernel.coarse[bin++];
+
+                // Bring its fine bins up to date: rebuild them if they are too old, otherwise slide them
+                uint16_t* fine = kernel.fine[bin];
+                int& end = fineEnd[bin];
+                if (end <= x) {
+                    std::memset(fine, 0, sizeof(kernel.fine[bin]));
+                    for (int col = x; col < x + ksize; ++col)
+                        for (int v = 0; v < 16; ++v)
+                            fine[v] += column(col).fine[bin][v];
+                } else {
+                    for (; end < x + ksize; ++end)
+                        for (int v = 0; v < 16; ++v)
+                            fine[v] += column(end).fine[bin][v] - column(end - ksize).fine[bin][v];
+                }
+                end = x + ksize;
+
+                int value = 0;
+                while (count + fine[value] <= target)
+                    count += fine[value++];
+                out[x * channels + c] = static_cast<uchar>(bin * 16 + value);
+            }
+        }
+    }
+}
+
+void medianBlurCT(const cv::Mat& src, cv::Mat& dst, int ksize) {
+    CV_Assert(ksize > 1 && ksize % 2 == 1);
+    if (src.depth() != CV_8U || ksize < constantTimeMinKernel || ksize > 255) {
+        cv::medianBlur(src, dst, ksize);
+        return;
+    }
+
+    const int radius = ksize / 2;
+    cv::Mat padded;
+    cv::copyMakeBorder(src, padded, radius, radius, radius, radius, cv::BORDER_REPLICATE);
+    dst.create(src.size(), src.type());
+
+    // Every band starts by filling the column histograms with ksize rows, so bands have to be tall compared to
+    // the aperture
+    const int threads = std::max(1, cv::getNumThreads());
+    const int bandRows = std::max(4 * ksize, (src.rows + threads - 1) / threads);
+    const int bands = (src.rows + bandRows - 1) / bandRows;
+
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+        for (int band = range.start; band < range.end; ++band) {
+            int y0 = band * bandRows;
+            medianBand(padded, dst, ksize, y0, std::min(src.rows, y0 + bandRows));
+        }
+    });
+}
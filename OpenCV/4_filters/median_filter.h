@@ -0,0 +1,11 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Median filter whose cost per pixel does not depend on the aperture (Perreault & Hebert, "Median Filtering in
+// Constant Time"). Every image column keeps a histogram of the ksize values above and below the current row;
+// moving down one row changes two entries per column histogram, moving right one pixel adds one column histogram
+// to the kernel histogram and removes another. Histograms are split into 16 coarse and 16x16 fine bins, so only
+// the fine bins next to the median have to be kept up to date.
+// Same result as cv::medianBlur (replicated border). 8-bit images with any number of channels; horizontal bands
+// are filtered in parallel. Small apertures and other depths are passed to cv::medianBlur.
+void medianBlurCT(const cv::Mat& src, cv::Mat& dst, int ksize);
@@ -0,0 +1,77 @@
+#include "panel_grid.h"
+
+// Conversion code between the channel counts of 8-bit gray, BGR and BGRA images, -1 if there is none
+static int channelConversion(int from, int to) {
+    if (from == 1 && to == 3) return cv::COLOR_GRAY2BGR;
+    if (from == 1 && to == 4) return cv::COLOR_GRAY2BGRA;
+    if (from == 3 && to == 1) return cv::COLOR_BGR2GRAY;
+    if (from == 3 && to == 4) return cv::COLOR_BGR2BGRA;
+    if (from == 4 && to == 1) return cv::COLOR_BGRA2GRAY;
+    if (from == 4 && to == 3) return cv::COLOR_BGRA2BGR;
+    return -1;
+}
+
+// Copies a result that could not be written in place into its cell
+static void fitToCell(const cv::Mat& result, cv::Mat& cell) {
+    cv::Mat converted = result;
+    if (converted.depth() != cell.depth()) {
+        cv::Mat scaled;
+        if (cell.depth() == CV_8U)
+            cv::convertScaleAbs(converted, scaled);  // Like the signed derivatives are usually shown
+        else
+            converted.convertTo(scaled, cell.depth());
+        converted = scaled;
+    }
+    if (converted.channels() != cell.channels()) {
+        int code = channelConversion(converted.channels(), cell.channels());
+        CV_Assert(code >= 0);
+        cv::Mat colored;
+        cv::cvtColor(converted, colored, code);
+        converted = colored;
+    }
+    if (converted.size() != cell.size()) {
+        cv::Mat resized;
+        cv::resize(converted, resized, cell.size(), 0, 0, cv::INTER_AREA);
+        converted = resized;
+    }
+    converted.copyTo(cell);
+}
+
+PanelGrid::PanelGrid(cv::Size panelSize, int type, int columns, int rows)
+    : panelSize(panelSize), columns(columns), rows(rows) {
+    CV_Assert(columns > 0 && rows > 0);
+    canvas = cv::Mat::zeros(panelSize.height * rows, panelSize.width * columns, type);
+}
+
+PanelGrid& PanelGrid::add(Renderer renderer) {
+    CV_Assert(static_cast<int>(renderers.size()) < columns * rows);
+    renderers.push_back(std::move(renderer));
+    return *this;
+}
+
+PanelGrid& PanelGrid::add(const cv::Mat& image) {
+    return add([image](cv::Mat& view) { fitToCell(image, view); });
+}
+
+cv::Mat PanelGrid::cell(int index) const {
+    cv::Rect area((index % columns) * panelSize.width, (index / columns) * panelSize.height,
+                  panelSize.width, panelSize.height);
+    return canvas(area);
+}
+
+const cv::Mat& PanelGrid::render() {
+    // Every panel writes only into its own cell. OpenCV runs a parallel_for_ nested in this one serially, so the
+    // panels do not oversubscribe the cores, and single-threaded renderers and conversions run in parallel too
+    cv::parallel_for_(cv::Range(0, static_cast<int>(renderers.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            cv::Mat view = cell(i);
+            const uchar* target = view.data;
+            renderers[i](view);
+            if (view.data != target) {
+                cv::Mat destination = cell(i);
+                fitToCell(view, destination);
+            }
+        }
+    });
+    return canvas;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <vector>
+
+// Side-by-side comparison of filter results in one image, without an intermediate Mat per panel.
+// Every panel is a function that receives the view of its cell in the canvas and writes its result there;
+// OpenCV functions write into a dst of the right size and type in place, so `cv::blur(image, view, ...)`
+// fills the cell directly. The panels are rendered concurrently. A panel that produces a different size or
+// type makes its view reallocate; that result is converted and copied into the cell instead.
+class PanelGrid {
+public:
+    using Renderer = std::function<void(cv::Mat& view)>;
+
+    PanelGrid(cv::Size panelSize, int type, int columns, int rows);
+
+    // Fills the next free cell, row by row
+    PanelGrid& add(Renderer renderer);
+    // Shows an existing image, e.g. the input
+    PanelGrid& add(const cv::Mat& image);
+
+    // Runs all panels; may be called again, e.g. for every frame
+    const cv::Mat& render();
+
+    const cv::Mat& image() const { return canvas; }
+    // View of the cell with the given index
+    cv::Mat cell(int index) const;
+
+private:
+    cv::Size panelSize;
+    int columns, rows;
+    cv::Mat canvas;
+    std::vector<Renderer> renderers;
+};
@@ -0,0 +1,105 @@
+#include "tiled_filter_pipeline.h"
+#include "fast_morphology.h"
+#include <algorithm>
+#include <cmath>
+
+void applyFilterChain(const cv::Mat& image, FilterChainBuffers& buffers, const FilterChainParams& params) {
+    // Apply Gaussian blur
+    cv::GaussianBlur(image, buffers.blurred, params.blurSize, 0);
+
+    // Sobel operators
+    cv::Sobel(buffers.blurred, buffers.grad_x, CV_16S, 1, 0, params.sobelKernelSize);
+    cv::Sobel(buffers.blurred, buffers.grad_y, CV_16S, 0, 1, params.sobelKernelSize);
+
+    // Convert gradients to absolute versions
+    cv::convertScaleAbs(buffers.grad_x, buffers.abs_grad_x);
+    cv::convertScaleAbs(buffers.grad_y, buffers.abs_grad_y);
+
+    // Combine gradients
+    cv::addWeighted(buffers.abs_grad_x, 0.5, buffers.abs_grad_y, 0.5, 0, buffers.edge_detected);
+
+    // Apply morphological close
+    fastMorphologyEx(buffers.edge_detected, buffers.morphology_output, cv::MORPH_CLOSE, params.morphKernel);
+
+    // Apply custom filtering
+    cv::filter2D(buffers.morphology_output, buffers.customFiltered, -1, params.customKernel);
+}
+
+// Largest distance (in pixels) a kernel with the default centered anchor reaches to one side of a pixel
+static int kernelReach(int kernelSize) {
+    return std::max(kernelSize / 2, kernelSize - 1 - kernelSize / 2);
+}
+
+TiledFilterPipeline::TiledFilterPipeline(const FilterChainParams& params, size_t tileBytes)
+    : params(params), tileBytes(tileBytes) {
+    // Every stage can corrupt as many pixels next to a cut as its kernel reaches,
+    // and the errors of consecutive stages add up. Close = dilate + erode
+    int sobelReach = std::max(1, params.sobelKernelSize / 2);
+    int morphReachX = params.morphKernel.empty() ? 1 : kernelReach(params.morphKernel.cols);
+    int morphReachY = params.morphKernel.empty() ? 1 : kernelReach(params.morphKernel.rows);
+    halo.width = kernelReach(params.blurSize.width) + sobelReach + 2 * morphReachX +
+                 kernelReach(params.customKernel.cols);
+    halo.height = kernelReach(params.blurSize.height) + sobelReach + 2 * morphReachY +
+                  kernelReach(params.customKernel.rows);
+}
+
+cv::Size TiledFilterPipeline::tileSize(const cv::Mat& frame) const {
+    // Bytes of one pixel over all intermediates: six 8-bit images and the two 16-bit gradients
+    const size_t bytesPerPixel = static_cast<size_t>(frame.channels()) * (6 + 2 * sizeof(short));
+    const double bandPixels = static_cast<double>(tileBytes) / bytesPerPixel;
+
+    // A square band has the least halo for its area; a frame narrower than that is not cut vertically at all
+    int bandCols = static_cast<int>(std::sqrt(bandPixels));
+    cv::Size tile;
+    if (frame.cols <= bandCols - 2 * halo.width) {
+        tile.width = frame.cols;
+        bandCols = frame.cols;
+    } else {
+        tile.width = bandCols - 2 * halo.width;
+    }
+    tile.height = static_cast<int>(bandPixels / std::max(bandCols, 1)) - 2 * halo.height;
+    tile.width = std::clamp(tile.width, 1, frame.cols);
+    tile.height = std::clamp(tile.height, 1, frame.rows);
+
+    // Give every thread at least one tile: a frame smaller than the thread count times the budget gets lower tiles
+    const int threads = std::max(1, cv::getNumThreads());
+    const int tileColumns = (frame.cols + tile.width - 1) / tile.width;
+    const int tileRowsWanted = (threads + tileColumns - 1) / tileColumns;
+    tile.height = std::max(1, std::min(tile.height, (frame.rows + tileRowsWanted - 1) / tileRowsWanted));
+    return tile;
+}
+
+void TiledFilterPipeline::process(const cv::Mat& frame, cv::Mat& output) {
+    CV_Assert(!frame.empty());
+    output.create(frame.size(), CV_8UC(frame.channels()));
+
+    const cv::Size tile = tileSize(frame);
+    const int tileColumns = (frame.cols + tile.width - 1) / tile.width;
+    const int tileCount = tileColumns * ((frame.rows + tile.height - 1) / tile.height);
+    // Worker w processes the tiles w, w + workers, ... with its own buffers
+    const int workers = std::min(tileCount, std::max(1, cv::getNumThreads()));
+    if (static_cast<int>(workerBuffers.size()) < workers)
+        workerBuffers.resize(workers);
+    const cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+
+    cv::parallel_for_(cv::Range(0, workers), [&](const cv::Range& range) {
+        for (int worker = range.start; worker < range.end; ++worker) {
+            FilterChainBuffers& buffers = workerBuffers[worker];
+            for (int index = worker; index < tileCount; index += workers) {
+                // Output pixels of this tile and the input band including the halo
+                const cv::Point origin((index % tileColumns) * tile.width, (index / tileColumns) * tile.height);
+                const cv::Rect tileRect = cv::Rect(origin, tile) & frameRect;
+                const cv::Rect band = cv::Rect(tileRect.x - halo.width, tileRect.y - halo.height,
+                                               tileRect.width + 2 * halo.width,
+                                               tileRect.height + 2 * halo.height) & frameRect;
+
+                // At the real edges of the frame the band has no halo, so the filters
+                // extrapolate exactly like they do on the full frame.
+                applyFilterChain(frame(band), buffers, params);
+
+                cv::Mat tileOutput = output(tileRect);
+                buffers.customFiltered(tileRect - band.tl()).copyTo(tileOutput);
+            }
+        }
+    }, workers);
+}
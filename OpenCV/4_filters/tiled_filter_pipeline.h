@@ -0,0 +1,53 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Parameters of the filter chain used by the video processing example:
+// GaussianBlur -> Sobel x/y -> convertScaleAbs -> addWeighted -> morphologyEx(CLOSE) -> filter2D
+struct FilterChainParams {
+    cv::Size blurSize = cv::Size(5, 5);
+    int sobelKernelSize = 3;
+    cv::Mat morphKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(5, 5));
+    cv::Mat customKernel = (cv::Mat_<float>(3,3) <<
+                                                 0, -1,  0,
+            -1,  5, -1,
+            0, -1,  0);  // Example of a sharpening kernel
+};
+
+// Intermediate images of one run of the chain
+struct FilterChainBuffers {
+    cv::Mat blurred, grad_x, grad_y;
+    cv::Mat abs_grad_x, abs_grad_y, edge_detected;
+    cv::Mat morphology_output, customFiltered;
+};
+
+// Runs the chain over the whole image as seven full-frame passes. This is the reference the tiled
+// pipeline has to reproduce bit-exactly; the result is left in buffers.customFiltered.
+void applyFilterChain(const cv::Mat& image, FilterChainBuffers& buffers, const FilterChainParams& params);
+
+// Splits every frame into tiles and runs the whole chain on each tile before moving on, so the intermediates of a
+// tile stay in cache. Tiles are processed in parallel with cv::parallel_for_.
+// Every tile is extended by a halo on all sides: the pixels closer than the halo to a cut are wrong (the filters
+// extrapolate there) and are thrown away, so the output is identical to applyFilterChain.
+// The tiles are sized so that a tile with its halo and all intermediates fits into tileBytes. A frame narrow enough
+// is cut into full-width rows only; wider frames (e.g. 4K) are cut into roughly square tiles, which need the
+// smallest halo for their area.
+class TiledFilterPipeline {
+public:
+    explicit TiledFilterPipeline(const FilterChainParams& params = FilterChainParams(),
+                                 size_t tileBytes = 2 * 1024 * 1024);
+
+    void process(const cv::Mat& frame, cv::Mat& output);
+
+    // Number of extra columns (width) and rows (height) computed on each side of a tile
+    cv::Size haloSize() const { return halo; }
+
+    // Output pixels per tile for the given frame
+    cv::Size tileSize(const cv::Mat& frame) const;
+
+private:
+    FilterChainParams params;
+    size_t tileBytes;  // Working set budget of one tile (all intermediates, including the halo)
+    cv::Size halo;
+    std::vector<FilterChainBuffers> workerBuffers;  // Reused between frames, one set per parallel worker
+};
@@ -2,24 +2,19 @@
 #include <QApplication>
 #include <QVBoxLayout>
 #include <opencv2/imgproc.hpp>
-
-#ifndef RESOURCES_PATH
-#define RESOURCES_PATH "Undefined"
-#endif
+#include "resource_cache.h"
 
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), currentState(0) {
-    // Adjust the path to the image according to your setup
-    std::string resources_path = RESOURCES_PATH;
-    std::string imagePath = resources_path + std::string("OpenCV/lenna.jpg");
-
-    originalImage = cv::imread(imagePath);  // Ensure path is correct
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    originalImage = loadResourceImage("OpenCV/lenna.jpg");
     if (originalImage.empty()) {
         // Handle error
     }
+    transformChain.reset(originalImage);
 
     imageLabel = new QLabel(this);
-    QPixmap pixmap = QPixmap::fromImage(QImage(originalImage.data, originalImage.cols, originalImage.rows, QImage::Format_RGB888).rgbSwapped());
+    QPixmap pixmap = QPixmap::fromImage(imageConverter.convert(originalImage));
     imageLabel->setPixmap(pixmap);
 
     actionButton = new QPushButton("Upscale", this);
@@ -69,19 +64,17 @@ void MainWindow::processImage() {
 }
 
 void MainWindow::revertImage() {
-    QPixmap pixmap = QPixmap::fromImage(QImage(originalImage.data, originalImage.cols, originalImage.rows, QImage::Format_RGB888).rgbSwapped());
+    QPixmap pixmap = QPixmap::fromImage(imageConverter.convert(originalImage));
     imageLabel->setPixmap(pixmap);
+    transformChain.reset(originalImage);
     timer->stop();
 }
 
 void MainWindow::upscaleImage() {
-    // Upscale the image by a factor of 2.0
-    cv::Mat tempImage;
-    cv::resize(originalImage, tempImage, cv::Size(), 2.0, 2.0, cv::INTER_LINEAR);
-
-    // Crop the upscaled image to the original image size from the top-left corner
-    cv::Rect roi(0, 0, originalImage.cols, originalImage.rows);  // ROI in the original size
-    transformedImage = tempImage(roi).clone();  // Crop and clone the ROI to get the cropped image
+    // Upscale the image by a factor of 2.0. The output keeps the original image size,
+    // so this is the top-left corner of the upscaled image; only that quarter is computed
+    transformChain.scale(2.0, 2.0);
+    transformChain.render(transformedImage);
 
     displayTransformedImage();
     setButtonText("Translate");
@@ -90,7 +83,8 @@ void MainWindow::upscaleImage() {
 
 void MainWindow::translateImage() {
     cv::Mat translationMat = (cv::Mat_<double>(2,3) << 1, 0, 100, 0, 1, 50);
-    cv::warpAffine(originalImage, transformedImage, translationMat, originalImage.size());
+    transformChain.affine(translationMat);
+    transformChain.render(transformedImage);
     displayTransformedImage();
     setButtonText("Rotate");
 }
@@ -98,7 +92,8 @@ void MainWindow::translateImage() {
 void MainWindow::rotateImage() {
     cv::Point2f center(originalImage.cols/2.0, originalImage.rows/2.0);
     cv::Mat rotationMat = cv::getRotationMatrix2D(center, 45, 1);
-    cv::warpAffine(originalImage, transformedImage, rotationMat, originalImage.size());
+    transformChain.affine(rotationMat);
+    transformChain.render(transformedImage);
     displayTransformedImage();
     setButtonText("Affine transform");
 }
@@ -119,8 +114,9 @@ void MainWindow::affineTransform() {
     // Get the Affine Transform Matrix
     cv::Mat warp_mat = cv::getAffineTransform(srcTri, dstTri);
 
-    // Apply the Affine Transform just found to the src image
-    cv::warpAffine(originalImage, transformedImage, warp_mat, originalImage.size());
+    // Apply the Affine Transform just found on top of the previous transformations
+    transformChain.affine(warp_mat);
+    transformChain.render(transformedImage);
     displayTransformedImage();
     setButtonText("Perspective transform");
 }
@@ -143,21 +139,20 @@ void MainWindow::perspectiveTransform() {
     // Get the Perspective Transform Matrix
     cv::Mat warpMatrix = cv::getPerspectiveTransform(srcQuad, dstQuad);
 
-    // Apply the Perspective Transformation to the image
-    cv::warpPerspective(originalImage, transformedImage, warpMatrix, originalImage.size());
+    // Apply the Perspective Transformation on top of the previous transformations
+    transformChain.perspective(warpMatrix);
+    transformChain.render(transformedImage);
     displayTransformedImage();
     setButtonText("Exit");
 }
 
 void MainWindow::displayTransformedImage() {
-    QImage qimg(transformedImage.data, transformedImage.cols, transformedImage.rows, transformedImage.step, QImage::Format_RGB888);
-    QPixmap pixmap = QPixmap::fromImage(qimg.rgbSwapped());
-
-    // Resize pixmap to fit in the label if it is larger than label
-    if (imageLabel->size().width() < pixmap.width() || imageLabel->size().height() < pixmap.height()) {
-        pixmap = pixmap.scaled(imageLabel->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    }
+    // Shrink to the label with area resampling before the conversion, so only the displayed pixels are converted.
+    // An image that fits is shared as it is
+    downscaleToFit(transformedImage, displayImage, cv::Size(imageLabel->width(), imageLabel->height()));
 
+    // Shares the pixels with Qt when possible, otherwise swaps BGR to RGB into a reused buffer
+    QPixmap pixmap = QPixmap::fromImage(imageConverter.convert(displayImage));
     imageLabel->setPixmap(pixmap);
     timer->start(10000); // Start or restart the timer for 10 seconds
 }
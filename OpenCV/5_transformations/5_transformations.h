@@ -4,6 +4,8 @@
 #include <QLabel>
 #include <QTimer>
 #include <opencv2/opencv.hpp>
+#include "mat_qimage.h"
+#include "transform_chain.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -27,6 +29,9 @@ private:
 
     cv::Mat originalImage;
     cv::Mat transformedImage;
+    cv::Mat displayImage;  // transformedImage scaled down to the label
+    MatToQImageConverter imageConverter;
+    TransformChain transformChain;  // Transformations applied since the last revert, resampled in one pass
     QLabel *imageLabel;
     QPushButton *actionButton;
     QTimer *timer;
@@ -0,0 +1,119 @@
+#include "transform_chain.h"
+#include "zoom_region.h"
+#include <cmath>
+
+static bool nearlyEqual(double a, double b) {
+    return std::abs(a - b) < 1e-9;
+}
+
+TransformChain::TransformChain(const cv::Mat& source) {
+    reset(source);
+}
+
+void TransformChain::reset(const cv::Mat& newSource) {
+    source = newSource;
+    homography = cv::Mat::eye(3, 3, CV_64F);
+    size = newSource.size();
+}
+
+TransformChain& TransformChain::append(const cv::Mat& M) {
+    // The new transformation is applied after the ones collected so far
+    homography = M * homography;
+    return *this;
+}
+
+TransformChain& TransformChain::scale(double sx, double sy) {
+    // Pixel centers: x' + 0.5 = sx * (x + 0.5)
+    cv::Mat S = (cv::Mat_<double>(3,3) << sx, 0, 0.5 * (sx - 1), 0, sy, 0.5 * (sy - 1), 0, 0, 1);
+    return append(S);
+}
+
+TransformChain& TransformChain::translate(double tx, double ty) {
+    cv::Mat T = (cv::Mat_<double>(3,3) << 1, 0, tx, 0, 1, ty, 0, 0, 1);
+    return append(T);
+}
+
+TransformChain& TransformChain::rotate(cv::Point2f center, double angle, double scale) {
+    return affine(cv::getRotationMatrix2D(center, angle, scale));
+}
+
+TransformChain& TransformChain::affine(const cv::Mat& M) {
+    CV_Assert(M.rows == 2 && M.cols == 3);
+    cv::Mat A = cv::Mat::eye(3, 3, CV_64F);
+    cv::Mat top = A.rowRange(0, 2);
+    M.convertTo(top, CV_64F);
+    return append(A);
+}
+
+TransformChain& TransformChain::perspective(const cv::Mat& M) {
+    CV_Assert(M.rows == 3 && M.cols == 3);
+    cv::Mat P;
+    M.convertTo(P, CV_64F);
+    return append(P);
+}
+
+TransformChain& TransformChain::crop(const cv::Rect& roi) {
+    translate(-roi.x, -roi.y);
+    size = roi.size();
+    return *this;
+}
+
+TransformChain& TransformChain::setOutputSize(cv::Size newSize) {
+    size = newSize;
+    return *this;
+}
+
+bool TransformChain::isAffine() const {
+    return nearlyEqual(homography.at<double>(2, 0), 0) && nearlyEqual(homography.at<double>(2, 1), 0) &&
+           nearlyEqual(homography.at<double>(2, 2), 1);
+}
+
+void TransformChain::render(cv::Mat& dst, int interpolation, WarpMapCache* cache) const {
+    const cv::Mat& H = homography;
+    double a = H.at<double>(0, 0), b = H.at<double>(0, 1), c = H.at<double>(0, 2);
+    double d = H.at<double>(1, 0), e = H.at<double>(1, 1), f = H.at<double>(1, 2);
+
+    if (isAffine() && nearlyEqual(b, 0) && nearlyEqual(d, 0)) {
+        // Translation by whole pixels: a crop, no resampling at all
+        if (nearlyEqual(a, 1) && nearlyEqual(e, 1) && nearlyEqual(c, std::round(c)) && nearlyEqual(f, std::round(f))) {
+            cv::Rect outputInSource(-cvRound(c), -cvRound(f), size.width, size.height);
+            cv::Rect inside = outputInSource & cv::Rect(0, 0, source.cols, source.rows);
+            if (inside == outputInSource) {
+                dst = source(outputInSource);
+                return;
+            }
+            dst.create(size, source.type());
+            dst.setTo(cv::Scalar::all(0));
+            if (!inside.empty())
+                source(inside).copyTo(dst(inside - outputInSource.tl()));
+            return;
+        }
+
+        // The whole source scaled to exactly fill the output: the mapping of cv::resize
+        double fx = size.width / static_cast<double>(source.cols);
+        double fy = size.height / static_cast<double>(source.rows);
+        if (nearlyEqual(a, fx) && nearlyEqual(e, fy) && nearlyEqual(c, 0.5 * (fx - 1)) && nearlyEqual(f, 0.5 * (fy - 1))) {
+            cv::resize(source, dst, size, 0, 0, interpolation);
+            return;
+        }
+
+        // Any other zoom and pan: only the part of the scaled image that ends up in the output is computed
+        if (a > 0 && e > 0) {
+            zoomRegion(source, dst, a, e, cv::Point2d(0.5 * (a - 1) - c, 0.5 * (e - 1) - f), size, interpolation);
+            return;
+        }
+    }
+
+    if (isAffine()) {
+        cv::Mat M = H.rowRange(0, 2);
+        if (cache)
+            cache->warpAffine(source, dst, M, size, interpolation);
+        else
+            cv::warpAffine(source, dst, M, size, interpolation);
+    } else {
+        if (cache)
+            cache->warpPerspective(source, dst, H, size, interpolation);
+        else
+            cv::warpPerspective(source, dst, H, size, interpolation);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "warp_map_cache.h"
+
+// Collects geometric transformations of a source image symbolically, as one 3x3 homography (source -> output
+// coordinates) and an output size. The image is resampled exactly once, when the pixels are requested, so
+// upscale -> translate -> rotate costs one interpolation instead of three and loses no extra quality.
+// Depending on the accumulated matrix the pixels are produced by a plain crop, a cv::resize, a zoomRegion,
+// a cv::warpAffine or a cv::warpPerspective.
+class TransformChain {
+public:
+    explicit TransformChain(const cv::Mat& source = cv::Mat());
+
+    // Starts over from the identity; the output size becomes the source size
+    void reset(const cv::Mat& source);
+
+    // Scales around the pixel centers, with the same convention as cv::resize; the output size is kept
+    TransformChain& scale(double sx, double sy);
+    TransformChain& translate(double tx, double ty);
+    // Same parameters as cv::getRotationMatrix2D
+    TransformChain& rotate(cv::Point2f center, double angle, double scale = 1.0);
+    TransformChain& affine(const cv::Mat& M);       // 2x3 matrix
+    TransformChain& perspective(const cv::Mat& M);  // 3x3 matrix
+    // Keeps the given rectangle of the current output
+    TransformChain& crop(const cv::Rect& roi);
+    TransformChain& setOutputSize(cv::Size size);
+
+    const cv::Mat& matrix() const { return homography; }
+    cv::Size outputSize() const { return size; }
+    bool isAffine() const;
+
+    // Resamples the source once. The result may share pixels with the source when the chain is a plain crop.
+    void render(cv::Mat& dst, int interpolation = cv::INTER_LINEAR, WarpMapCache* cache = nullptr) const;
+
+private:
+    TransformChain& append(const cv::Mat& M);
+
+    cv::Mat source;
+    cv::Mat homography;  // CV_64F 3x3
+    cv::Size size;
+};
@@ -0,0 +1,87 @@
+#include "warp_map_cache.h"
+#include <algorithm>
+
+bool WarpMapCache::Key::operator==(const Key& other) const {
+    return matrix == other.matrix && width == other.width && height == other.height && flags == other.flags;
+}
+
+WarpMapCache::WarpMapCache(size_t capacity) : capacity(std::max<size_t>(capacity, 1)) {}
+
+void WarpMapCache::warpAffine(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize,
+                              int flags, int borderMode, const cv::Scalar& borderValue) {
+    warp(src, dst, M, dsize, flags, borderMode, borderValue, false);
+}
+
+void WarpMapCache::warpPerspective(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize,
+                                   int flags, int borderMode, const cv::Scalar& borderValue) {
+    warp(src, dst, M, dsize, flags, borderMode, borderValue, true);
+}
+
+// cv::remap has no area interpolation; like cv::warpAffine, fall back to bilinear
+static int remapInterpolation(int flags) {
+    int interpolation = flags & cv::INTER_MAX;
+    return interpolation == cv::INTER_AREA ? cv::INTER_LINEAR : interpolation;
+}
+
+const WarpMapCache::Entry& WarpMapCache::lookup(const cv::Mat& M, cv::Size dsize, int flags, bool perspective) {
+    cv::Mat matrix;
+    M.convertTo(matrix, CV_64F);
+    CV_Assert(matrix.rows == (perspective ? 3 : 2) && matrix.cols == 3);
+
+    Key key;
+    key.matrix = {0, 0, 0, 0, 0, 0, 0, 0, 1};
+    std::copy(matrix.ptr<double>(0), matrix.ptr<double>(0) + matrix.rows * 3, key.matrix.begin());
+    key.width = dsize.width;
+    key.height = dsize.height;
+    key.flags = remapInterpolation(flags) | (flags & cv::WARP_INVERSE_MAP);
+
+    auto found = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.key == key; });
+    if (found != entries.end()) {
+        ++hitCount;
+        entries.splice(entries.begin(), entries, found);
+        return entries.front();
+    }
+    ++missCount;
+
+    // The tables map every destination pixel back to the source, so the inverse of the warp is needed
+    cv::Mat inverse;
+    if (flags & cv::WARP_INVERSE_MAP)
+        inverse = matrix;
+    else if (perspective)
+        cv::invert(matrix, inverse);
+    else
+        cv::invertAffineTransform(matrix, inverse);
+
+    // Coordinates of every destination pixel, transformed into source coordinates
+    cv::Mat destination(dsize, CV_32FC2), mapXY;
+    for (int y = 0; y < dsize.height; ++y) {
+        float* row = destination.ptr<float>(y);
+        for (int x = 0; x < dsize.width; ++x) {
+            row[2 * x] = static_cast<float>(x);
+            row[2 * x + 1] = static_cast<float>(y);
+        }
+    }
+    if (perspective)
+        cv::perspectiveTransform(destination, mapXY, inverse);
+    else
+        cv::transform(destination, mapXY, inverse);
+
+    // Fixed-point tables are smaller and faster to apply than the float coordinates
+    Entry entry;
+    entry.key = key;
+    bool nearest = remapInterpolation(flags) == cv::INTER_NEAREST;
+    cv::convertMaps(mapXY, cv::noArray(), entry.map1, entry.map2, CV_16SC2, nearest);
+
+    entries.push_front(std::move(entry));
+    if (entries.size() > capacity)
+        entries.pop_back();
+    return entries.front();
+}
+
+void WarpMapCache::warp(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize, int flags,
+                        int borderMode, const cv::Scalar& borderValue, bool perspective) {
+    if (dsize.width <= 0 || dsize.height <= 0)
+        dsize = src.size();
+    const Entry& entry = lookup(M, dsize, flags, perspective);
+    cv::remap(src, dst, entry.map1, entry.map2, remapInterpolation(flags), borderMode, borderValue);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <list>
+
+// Drop-in replacement for cv::warpAffine / cv::warpPerspective for warps that are applied again and again,
+// e.g. the rectification of every frame of a camera stream. The per-pixel source coordinates depend only on
+// the matrix, the output size and the interpolation, so they are computed once, stored as fixed-point
+// cv::convertMaps tables and applied with cv::remap afterwards. The least recently used tables are dropped
+// when more than `capacity` different warps are in use. Not thread-safe.
+class WarpMapCache {
+public:
+    explicit WarpMapCache(size_t capacity = 8);
+
+    void warpAffine(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize,
+                    int flags = cv::INTER_LINEAR, int borderMode = cv::BORDER_CONSTANT,
+                    const cv::Scalar& borderValue = cv::Scalar());
+
+    void warpPerspective(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize,
+                         int flags = cv::INTER_LINEAR, int borderMode = cv::BORDER_CONSTANT,
+                         const cv::Scalar& borderValue = cv::Scalar());
+
+    size_t hits() const { return hitCount; }
+    size_t misses() const { return missCount; }
+    void clear() { entries.clear(); }
+
+private:
+    struct Key {
+        std::array<double, 9> matrix;  // 2x3 matrices are stored with a 0 0 1 last row
+        int width, height;
+        int flags;                     // Interpolation and WARP_INVERSE_MAP
+        bool operator==(const Key& other) const;
+    };
+    struct Entry {
+        Key key;
+        cv::Mat map1, map2;  // CV_16SC2 integer coordinates and CV_16UC1 interpolation table indices
+    };
+
+    const Entry& lookup(const cv::Mat& M, cv::Size dsize, int flags, bool perspective);
+    void warp(const cv::Mat& src, cv::Mat& dst, const cv::Mat& M, cv::Size dsize, int flags,
+              int borderMode, const cv::Scalar& borderValue, bool perspective);
+
+    size_t capacity;
+    std::list<Entry> entries;  // Most recently used first
+    size_t hitCount = 0;
+    size_t missCount = 0;
+};
@@ -0,0 +1,72 @@
+#include "zoom_region.h"
+#include <algorithm>
+#include <cmath>
+
+static bool isWhole(double value) {
+    return std::abs(value - std::round(value)) < 1e-9;
+}
+
+// Source pixels that cv::resize reads on each side of the interpolated position
+static int interpolationMargin(int interpolation) {
+    switch (interpolation) {
+        case cv::INTER_CUBIC:
+            return 2;
+        case cv::INTER_LANCZOS4:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+// Renders a window that lies completely inside the scaled image into `out`, which already has its final size
+static void zoomInside(const cv::Mat& src, cv::Mat& out, double fx, double fy, cv::Point2d pan, int interpolation) {
+    cv::Size size = out.size();
+
+    if (isWhole(fx) && isWhole(fy) && isWhole(pan.x) && isWhole(pan.y)) {
+        // Every scaled pixel keeps its interpolation weights when a sub-rectangle of the source is resized,
+        // so resizing just the pixels under the window (plus the interpolation support) is exact
+        int sx = cvRound(fx), sy = cvRound(fy);
+        int px = cvRound(pan.x), py = cvRound(pan.y);
+        int margin = interpolationMargin(interpolation);
+        int left = std::max(0, px / sx - margin);
+        int top = std::max(0, py / sy - margin);
+        int right = std::min(src.cols, (px + size.width - 1) / sx + 1 + margin);
+        int bottom = std::min(src.rows, (py + size.height - 1) / sy + 1 + margin);
+
+        cv::Mat zoomed;
+        cv::resize(src(cv::Range(top, bottom), cv::Range(left, right)), zoomed, cv::Size(), sx, sy, interpolation);
+        zoomed(cv::Rect(px - left * sx, py - top * sy, size.width, size.height)).copyTo(out);
+        return;
+    }
+
+    // Pixel centers: x_out + pan + 0.5 = fx * (x_src + 0.5)
+    cv::Mat M = (cv::Mat_<double>(2,3) << fx, 0, 0.5 * (fx - 1) - pan.x, 0, fy, 0.5 * (fy - 1) - pan.y);
+    cv::warpAffine(src, out, M, size, interpolation, cv::BORDER_REPLICATE);
+}
+
+void zoomRegion(const cv::Mat& src, cv::Mat& dst, double fx, double fy, cv::Point2d pan, cv::Size outSize,
+                int interpolation) {
+    CV_Assert(!src.empty() && fx > 0 && fy > 0);
+    cv::Mat source = src;
+    if (dst.data && dst.datastart == source.datastart)
+        dst.release();  // Never write into the pixels that are being read
+
+    // Part of the window covered by the scaled image
+    double scaledWidth = std::round(source.cols * fx), scaledHeight = std::round(source.rows * fy);
+    int x0 = std::max(0, static_cast<int>(std::ceil(-pan.x)));
+    int y0 = std::max(0, static_cast<int>(std::ceil(-pan.y)));
+    int x1 = std::min(outSize.width, static_cast<int>(std::ceil(scaledWidth - pan.x)));
+    int y1 = std::min(outSize.height, static_cast<int>(std::ceil(scaledHeight - pan.y)));
+
+    dst.create(outSize, source.type());
+    if (x1 <= x0 || y1 <= y0) {
+        dst.setTo(cv::Scalar::all(0));
+        return;
+    }
+    cv::Rect visible(x0, y0, x1 - x0, y1 - y0);
+    if (visible.size() != outSize)
+        dst.setTo(cv::Scalar::all(0));
+
+    cv::Mat window = dst(visible);
+    zoomInside(source, window, fx, fy, pan + cv::Point2d(x0, y0), interpolation);
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Computes only the visible window of a scaled image, as an interactive viewer needs it: `dst` (of `outSize`)
+// shows the image scaled by fx, fy (pixel-center convention of cv::resize) starting at the point `pan` of the
+// scaled image. The cost is proportional to the output, not to the scaled image.
+// Whole-number factors and pans resize only the source pixels under the window and give exactly the pixels of
+// cv::resize followed by a crop; any other zoom is one cv::warpAffine of the window. Parts of the window outside
+// of the scaled image are black. Zooming out with INTER_AREA falls back to bilinear, like cv::warpAffine.
+void zoomRegion(const cv::Mat& src, cv::Mat& dst, double fx, double fy, cv::Point2d pan, cv::Size outSize,
+                int interpolation = cv::INTER_LINEAR);
+
+inline void zoomRegion(const cv::Mat& src, cv::Mat& dst, double scale, cv::Point2d pan, cv::Size outSize,
+                       int interpolation = cv::INTER_LINEAR) {
+    zoomRegion(src, dst, scale, scale, pan, outSize, interpolation);
+}
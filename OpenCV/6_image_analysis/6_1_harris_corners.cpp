@@ -0,0 +1,35 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include "image_analysis.h"
+#include "resource_cache.h"
+
+int main() {
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
+
+    cv::Mat image = loadCachedImage(imagePath);
+    if (image.empty()) {
+        std::cerr << "Could not read the image: " << imagePath << std::endl;
+        return 1;
+    }
+    cv::Mat gray;
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+
+    // Harris corners (blockSize 2, Sobel aperture 3, k = 0.04), computed in horizontal bands in parallel
+    std::vector<cv::Point> corners = harrisCorners(gray, 0.01, 2, 3, 0.04);
+    std::cout << "Found " << corners.size() << " corners" << std::endl;
+
+    // Mark the corners on the image
+    cv::Mat displayImage = image.clone();
+    for (const cv::Point& corner : corners)
+        cv::circle(displayImage, corner, 4, cv::Scalar(0, 0, 255), 1);
+
+    // Show the result in the window
+    cv::namedWindow("Harris Corners", cv::WINDOW_AUTOSIZE);
+    cv::imshow("Harris Corners", displayImage);
+
+    // Wait for a key press indefinitely
+    cv::waitKey(0);
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include "image_analysis.h"
+#include "connected_blobs.h"
+#include "resource_cache.h"
+
+int main() {
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
+
+    cv::Mat image = loadCachedImage(imagePath);
+    if (image.empty()) {
+        std::cerr << "Could not read the image: " << imagePath << std::endl;
+        return 1;
+    }
+
+    // Contours need a binary image; Otsu's method picks the threshold
+    cv::Mat gray, binaryImage;
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    cv::threshold(gray, binaryImage, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+    // Outer contours of the white regions
+    std::vector<std::vector<cv::Point>> contours = extractContours(binaryImage);
+    std::cout << "Found " << contours.size() << " contours" << std::endl;
+
+    // Draw all contours on the image
+    cv::Mat displayImage = image.clone();
+    cv::drawContours(displayImage, contours, -1, cv::Scalar(0, 255, 0), 2);
+
+    // Boxes and centroids of the same regions come from connected-component labelling, without any contour
+    std::vector<Blob> blobs = findBlobs(binaryImage, 50);
+    std::cout << "Found " << blobs.size() << " regions of at least 50 pixels" << std::endl;
+    for (const Blob& blob : blobs) {
+        cv::rectangle(displayImage, blob.box, cv::Scalar(255, 0, 0), 1);
+        cv::circle(displayImage, blob.centroid, 3, cv::Scalar(0, 0, 255), -1);
+    }
+
+    // Show the result in the window
+    cv::namedWindow("Contours", cv::WINDOW_AUTOSIZE);
+    cv::imshow("Contours", displayImage);
+
+    // Wait for a key press indefinitely
+    cv::waitKey(0);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include "image_analysis.h"
+#include "histogram_engine.h"
+#include "resource_cache.h"
+
+int main() {
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
+
+    cv::Mat image = loadCachedImage(imagePath);
+    if (image.empty()) {
+        std::cerr << "Could not read the image: " << imagePath << std::endl;
+        return 1;
+    }
+
+    // Plot the histogram of every channel in its own color
+    const int bins = 256;
+    const int width = 512, height = 400;
+    const int binWidth = width / bins;
+    cv::Mat displayImage(height, width, CV_8UC3, cv::Scalar(0, 0, 0));
+    const cv::Scalar colors[] = {cv::Scalar(255, 0, 0), cv::Scalar(0, 255, 0), cv::Scalar(0, 0, 255)};
+
+    for (int channel = 0; channel < image.channels(); ++channel) {
+        // Counted in parallel with private per-thread histograms, same result as cv::calcHist
+        cv::Mat histogram = channelHistogram(image, channel, bins);
+
+        // Scale the counts to the height of the plot
+        cv::normalize(histogram, histogram, 0, height, cv::NORM_MINMAX);
+        for (int i = 1; i < bins; ++i) {
+            cv::line(displayImage,
+                     cv::Point(binWidth * (i - 1), height - cvRound(histogram.at<float>(i - 1))),
+                     cv::Point(binWidth * i, height - cvRound(histogram.at<float>(i))),
+                     colors[channel % 3], 2);
+        }
+    }
+
+    // Joint histogram of hue (rows) and saturation (columns), brighter = more pixels.
+    // 8-bit hue is stored as degrees / 2, so its range ends at 180
+    cv::Mat hsv;
+    cv::cvtColor(image, hsv, cv::COLOR_BGR2HSV);
+    const int hueBins = 30, saturationBins = 32;
+    cv::Mat hueSaturation = histogram2D(hsv, 0, 1, hueBins, saturationBins, cv::Mat(), cv::Range(0, 180));
+    cv::Mat hueSaturationImage;
+    cv::normalize(hueSaturation, hueSaturationImage, 0, 255, cv::NORM_MINMAX, CV_8U);
+    cv::resize(hueSaturationImage, hueSaturationImage, cv::Size(saturationBins * 10, hueBins * 10), 0, 0, cv::INTER_NEAREST);
+
+    // Show the results in windows
+    cv::namedWindow("Histogram", cv::WINDOW_AUTOSIZE);
+    cv::imshow("Histogram", displayImage);
+    cv::imshow("Hue-Saturation Histogram", hueSaturationImage);
+
+    // Wait for a key press indefinitely
+    cv::waitKey(0);
+
+    return 0;
+}
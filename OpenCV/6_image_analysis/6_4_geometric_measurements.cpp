@@ -0,0 +1,47 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include "image_analysis.h"
+#include "resource_cache.h"
+
+int main() {
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
+
+    cv::Mat image = loadCachedImage(imagePath);
+    if (image.empty()) {
+        std::cerr << "Could not read the image: " << imagePath << std::endl;
+        return 1;
+    }
+
+    // Shapes are the outer contours of the binarized image
+    cv::Mat gray, binaryImage;
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    cv::threshold(gray, binaryImage, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+    std::vector<std::vector<cv::Point>> contours = extractContours(binaryImage);
+
+    // Bounding box, minimum enclosing circle and ellipse of every contour, measured in parallel
+    std::vector<ShapeMeasurements> shapes = measureShapes(contours);
+
+    cv::Mat displayImage = image.clone();
+    int shown = 0;
+    for (const ShapeMeasurements& shape : shapes) {
+        // Skip the specks
+        if (shape.area < 100)
+            continue;
+        ++shown;
+        cv::rectangle(displayImage, shape.boundingBox, cv::Scalar(0, 255, 0), 1);
+        cv::circle(displayImage, shape.circleCenter, cvRound(shape.circleRadius), cv::Scalar(255, 0, 0), 1);
+        if (shape.hasEllipse)
+            cv::ellipse(displayImage, shape.ellipse, cv::Scalar(0, 0, 255), 1);
+    }
+    std::cout << "Measured " << shapes.size() << " shapes, showing the " << shown << " larger than 100 pixels" << std::endl;
+
+    // Show the result in the window
+    cv::namedWindow("Geometric Measurements", cv::WINDOW_AUTOSIZE);
+    cv::imshow("Geometric Measurements", displayImage);
+
+    // Wait for a key press indefinitely
+    cv::waitKey(0);
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <iostream>
+#include "image_analysis.h"
+#include "resource_cache.h"
+
+static void printHuMoments(const std::string& title, const std::array<double, 7>& hu) {
+    std::cout << title << std::endl;
+    for (size_t i = 0; i < hu.size(); ++i)
+        std::cout << "  h" << i + 1 << " = " << hu[i] << std::endl;
+}
+
+int main() {
+    // Decoded once, later runs map the cached pixels (see resource_cache.h)
+    std::string imagePath = resourcePath("OpenCV/lenna.jpg");
+
+    cv::Mat image = loadCachedImage(imagePath, cv::IMREAD_GRAYSCALE);
+    if (image.empty()) {
+        std::cerr << "Could not read the image: " << imagePath << std::endl;
+        return 1;
+    }
+
+    cv::Mat binaryImage;
+    cv::threshold(image, binaryImage, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+    // Hu moments of the whole binary image; the moments are summed from bands computed in parallel
+    printHuMoments("Hu moments of the binary image:", huMoments(imageMoments(binaryImage, true)));
+
+    // Hu moments of the largest shape
+    std::vector<std::vector<cv::Point>> contours = extractContours(binaryImage);
+    std::vector<ShapeMeasurements> shapes = measureShapes(contours);
+    auto largest = std::max_element(shapes.begin(), shapes.end(), [](const ShapeMeasurements& a, const ShapeMeasurements& b) {
+        return a.area < b.area;
+    });
+    if (largest != shapes.end()) {
+        printHuMoments("Hu moments of the largest contour:", largest->hu);
+
+        cv::Mat displayImage;
+        cv::cvtColor(binaryImage, displayImage, cv::COLOR_GRAY2BGR);
+        cv::drawContours(displayImage, contours, static_cast<int>(largest - shapes.begin()), cv::Scalar(0, 0, 255), 2);
+
+        // Show the result in the window
+        cv::namedWindow("Hu Moments", cv::WINDOW_AUTOSIZE);
+        cv::imshow("Hu Moments", displayImage);
+
+        // Wait for a key press indefinitely
+        cv::waitKey(0);
+    }
+
+    return 0;
+}
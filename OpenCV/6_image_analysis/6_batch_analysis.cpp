@@ -0,0 +1,40 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "analysis_batch.h"
+#include "batch_inputs.h"
+
+// Analyses every image of a directory or glob pattern, e.g.
+// 6_batch_analysis --input "images/*.jpg" --threads 8
+int main(int argc, char** argv) {
+    const std::string keys =
+            "{help h    |    | print this message}"
+            "{input i   |    | input directory or glob pattern, e.g. images/*.jpg}"
+            "{min-area  | 50 | smallest contour area that is measured}"
+            "{threads t | 0  | images analysed at once, 0 = one per core}";
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Extracts Harris corners, shapes, histograms and Hu moments of many images at once.");
+    if (parser.has("help") || !parser.has("input")) {
+        parser.printMessage();
+        return parser.has("help") ? 0 : 1;
+    }
+
+    std::string input = parser.get<std::string>("input");
+    AnalysisOptions options;
+    options.minShapeArea = parser.get<double>("min-area");
+    options.threads = static_cast<size_t>(std::max(0, parser.get<int>("threads")));
+    if (!parser.check()) {
+        parser.printErrors();
+        return 1;
+    }
+
+    std::vector<std::string> paths = listBatchInputs(input);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<ImageFeatures> features = analyzeImages(paths, options);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    printFeatureSummary(std::cout, features, elapsed.count());
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include "analysis_batch.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+ImageFeatures analyzeImage(const cv::Mat& image, const AnalysisOptions& options) {
+    ImageFeatures features;
+    if (image.empty())
+        return features;
+
+    cv::Mat gray;
+    if (image.channels() == 1)
+        gray = image;
+    else
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+
+    features.corners = harrisCorners(gray, options.harrisQuality);
+    features.histogram = channelHistogram(gray, 0, options.histogramBins);
+
+    cv::Mat binary;
+    if (options.threshold < 0)
+        cv::threshold(gray, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+    else
+        cv::threshold(gray, binary, options.threshold, 255, cv::THRESH_BINARY);
+    features.hu = huMoments(imageMoments(binary, true));
+
+    std::vector<std::vector<cv::Point>> contours = extractContours(binary);
+    if (options.minShapeArea > 0) {
+        contours.erase(std::remove_if(contours.begin(), contours.end(), [&](const std::vector<cv::Point>& contour) {
+            return cv::contourArea(contour) < options.minShapeArea;
+        }), contours.end());
+    }
+    features.shapes = measureShapes(contours);
+    features.ok = true;
+    return features;
+}
+
+std::vector<ImageFeatures> analyzeImages(const std::vector<std::string>& paths, const AnalysisOptions& options) {
+    // Parallelism comes from analysing whole images concurrently,
+    // so OpenCV's own threading is switched off to avoid oversubscribing the cores
+    int previousThreads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    std::vector<std::future<ImageFeatures>> pending;
+    {
+        ThreadPool pool(options.threads);
+        for (const std::string& path : paths) {
+            pending.push_back(pool.submit([&options, path] {
+                auto start = std::chrono::steady_clock::now();
+                ImageFeatures features = analyzeImage(cv::imread(path), options);
+                features.path = path;
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                features.latencyMs = elapsed.count();
+                return features;
+            }));
+        }
+    }
+    cv::setNumThreads(previousThreads);
+
+    std::vector<ImageFeatures> results;
+    for (auto& future : pending)
+        results.push_back(future.get());
+    return results;
+}
+
+void printFeatureSummary(std::ostream& os, const std::vector<ImageFeatures>& features, double seconds) {
+    size_t analysed = 0;
+    for (const ImageFeatures& image : features) {
+        if (!image.ok) {
+            os << image.path << ": could not be read" << std::endl;
+            continue;
+        }
+        ++analysed;
+        os << image.path << ": " << image.corners.size() << " corners, " << image.shapes.size() << " shapes, "
+           << image.latencyMs << " ms" << std::endl;
+    }
+    os << "Analysed " << analysed << " of " << features.size() << " images in " << seconds << " s ("
+       << analysed / std::max(seconds, 1e-9) << " images/s)" << std::endl;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "image_analysis.h"
+
+// What analyzeImage extracts from an image
+struct AnalysisOptions {
+    double harrisQuality = 0.01;  // Corners above this fraction of the strongest response
+    int threshold = -1;           // Binarization threshold for the contours, -1 = Otsu
+    double minShapeArea = 0;      // Smaller contours are not measured
+    int histogramBins = 256;
+    size_t threads = 0;           // Images analysed at once in analyzeImages, 0 = one per core
+};
+
+// Features of one image
+struct ImageFeatures {
+    std::string path;
+    bool ok = false;
+    std::vector<cv::Point> corners;
+    std::vector<ShapeMeasurements> shapes;
+    cv::Mat histogram;            // Gray level histogram
+    std::array<double, 7> hu{};   // Hu moments of the binarized image
+    double latencyMs = 0;         // Decode + analysis
+};
+
+// Harris corners, contours with their measurements, histogram and Hu moments of one image
+ImageFeatures analyzeImage(const cv::Mat& image, const AnalysisOptions& options = AnalysisOptions());
+
+// Analyses many images at once: every image is decoded and analysed by one worker of a thread pool.
+// OpenCV's own threading is switched off meanwhile, the parallelism comes from the images.
+std::vector<ImageFeatures> analyzeImages(const std::vector<std::string>& paths,
+                                         const AnalysisOptions& options = AnalysisOptions());
+
+void printFeatureSummary(std::ostream& os, const std::vector<ImageFeatures>& features, double seconds);
@@ -0,0 +1,186 @@
+#include "histogram_engine.h"
+#include <algorithm>
+#include <mutex>
+
+// Above this many bins the 4 sub-histograms no longer fit into the L1 cache and cost more than they save
+static const int maxInterleavedBins = 4096;
+
+// Maps the values of one or two channels to a bin index
+struct HistogramLayout {
+    int channel0, channel1;  // channel1 < 0 for 1-D histograms
+    int bins0, bins1;
+    bool clipped = false;  // Some values lie outside of the ranges
+    int lut0[256], lut1[256];
+
+    HistogramLayout(int channel0, int bins0, cv::Range range0, int channel1 = -1, int bins1 = 1,
+                    cv::Range range1 = cv::Range(0, 256))
+        : channel0(channel0), channel1(channel1), bins0(bins0), bins1(bins1) {
+        CV_Assert(bins0 > 0 && bins0 <= 256 && bins1 > 0 && bins1 <= 256);
+        CV_Assert(range0.start >= 0 && range0.start < range0.end && range0.end <= 256);
+        CV_Assert(range1.start >= 0 && range1.start < range1.end && range1.end <= 256);
+        if (channel1 < 0)
+            range1 = cv::Range(0, 256);
+        // Same uniform binning as cv::calcHist: floor((value - start) * bins / (end - start)); the first index is
+        // premultiplied. A value outside of its range maps to the discarded counters behind the real bins:
+        // [total, 2 * total], whatever the other channel adds
+        const int total = totalBins();
+        for (int v = 0; v < 256; ++v) {
+            lut0[v] = range0.start <= v && v < range0.end ? (v - range0.start) * bins0 / range0.size() * bins1 : total;
+            lut1[v] = channel1 < 0 ? 0 : range1.start <= v && v < range1.end ? (v - range1.start) * bins1 / range1.size()
+                                                                            : total;
+        }
+        clipped = range0.size() < 256 || range1.size() < 256;
+    }
+
+    int totalBins() const { return bins0 * bins1; }
+    // Counters of one sub-histogram, including the discarded ones
+    int stride() const { return clipped ? 2 * totalBins() + 1 : totalBins(); }
+};
+
+template<int SubHistograms>
+static void countRowsInto(const cv::Mat& image, const cv::Mat& mask, cv::Range rows, const HistogramLayout& layout,
+                          uint32_t* counts) {
+    const int total = layout.totalBins();
+    const int stride = layout.stride();
+    const int channels = image.channels();
+    const int c0 = layout.channel0, c1 = std::max(layout.channel1, 0);
+    const int* lut0 = layout.lut0;
+    const int* lut1 = layout.lut1;
+    std::vector<uint32_t> local(static_cast<size_t>(SubHistograms) * stride, 0);
+    uint32_t* sub = local.data();
+
+    for (int y = rows.start; y < rows.end; ++y) {
+        const uchar* p = image.ptr<uchar>(y);
+        const uchar* m = mask.empty() ? nullptr : mask.ptr<uchar>(y);
+        int x = 0;
+        if (!m) {
+            // Pixel x goes to sub-histogram x % SubHistograms
+            for (; x + SubHistograms <= image.cols; x += SubHistograms)
+                for (int s = 0; s < SubHistograms; ++s) {
+                    const uchar* pixel = p + (x + s) * channels;
+                    ++sub[s * stride + lut0[pixel[c0]] + lut1[pixel[c1]]];
+                }
+        }
+        for (; x < image.cols; ++x) {
+            if (m && !m[x])
+                continue;
+            const uchar* pixel = p + x * channels;
+            ++sub[lut0[pixel[c0]] + lut1[pixel[c1]]];
+        }
+    }
+
+    for (int s = 0; s < SubHistograms; ++s)
+        for (int i = 0; i < total; ++i)
+            counts[i] += sub[s * stride + i];
+}
+
+// Adds the counts of the given rows to `counts`
+static void countRows(const cv::Mat& image, const cv::Mat& mask, cv::Range rows, const HistogramLayout& layout,
+                      uint32_t* counts) {
+    if (layout.totalBins() <= maxInterleavedBins)
+        countRowsInto<4>(image, mask, rows, layout, counts);
+    else
+        countRowsInto<1>(image, mask, rows, layout, counts);
+}
+
+static cv::Mat toHistogramMat(const std::vector<uint32_t>& counts, const HistogramLayout& layout) {
+    cv::Mat histogram(layout.bins0, layout.channel1 < 0 ? 1 : layout.bins1, CV_32F);
+    float* out = histogram.ptr<float>(0);
+    for (int i = 0; i < layout.totalBins(); ++i)
+        out[i] = static_cast<float>(counts[i]);
+    return histogram;
+}
+
+static void checkInput(const cv::Mat& image, const cv::Mat& mask, const HistogramLayout& layout) {
+    CV_Assert(!image.empty() && image.depth() == CV_8U);
+    CV_Assert(layout.channel0 >= 0 && layout.channel0 < image.channels() && layout.channel1 < image.channels());
+    CV_Assert(mask.empty() || (mask.type() == CV_8UC1 && mask.size() == image.size()));
+}
+
+// One image, its rows split over the threads
+static cv::Mat computeHistogram(const cv::Mat& image, const cv::Mat& mask, const HistogramLayout& layout) {
+    checkInput(image, mask, layout);
+    std::vector<uint32_t> counts(layout.totalBins(), 0);
+    std::mutex mergeMutex;
+    cv::parallel_for_(cv::Range(0, image.rows), [&](const cv::Range& rows) {
+        std::vector<uint32_t> partial(layout.totalBins(), 0);
+        countRows(image, mask, rows, layout, partial.data());
+        std::lock_guard<std::mutex> lock(mergeMutex);
+        for (size_t i = 0; i < counts.size(); ++i)
+            counts[i] += partial[i];
+    }, cv::getNumThreads());
+    return toHistogramMat(counts, layout);
+}
+
+// Many images, each counted by a single thread
+static std::vector<cv::Mat> computeHistograms(const std::vector<cv::Mat>& images, const HistogramLayout& layout) {
+    std::vector<cv::Mat> histograms(images.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(images.size())), [&](const cv::Range& range) {
+        std::vector<uint32_t> counts(layout.totalBins());
+        for (int i = range.start; i < range.end; ++i) {
+            checkInput(images[i], cv::Mat(), layout);
+            std::fill(counts.begin(), counts.end(), 0);
+            countRows(images[i], cv::Mat(), cv::Range(0, images[i].rows), layout, counts.data());
+            histograms[i] = toHistogramMat(counts, layout);
+        }
+    });
+    return histograms;
+}
+
+cv::Mat histogram1D(const cv::Mat& image, int channel, int bins, const cv::Mat& mask, cv::Range range) {
+    return computeHistogram(image, mask, HistogramLayout(channel, bins, range));
+}
+
+cv::Mat histogram2D(const cv::Mat& image, int channel0, int channel1, int bins0, int bins1, const cv::Mat& mask,
+                    cv::Range range0, cv::Range range1) {
+    CV_Assert(channel1 >= 0);
+    return computeHistogram(image, mask, HistogramLayout(channel0, bins0, range0, channel1, bins1, range1));
+}
+
+std::vector<cv::Mat> histograms1D(const std::vector<cv::Mat>& images, int channel, int bins, cv::Range range) {
+    return computeHistograms(images, HistogramLayout(channel, bins, range));
+}
+
+std::vector<cv::Mat> histograms2D(const std::vector<cv::Mat>& images, int channel0, int channel1, int bins0, int bins1,
+                                  cv::Range range0, cv::Range range1) {
+    CV_Assert(channel1 >= 0);
+    return computeHistograms(images, HistogramLayout(channel0, bins0, range0, channel1, bins1, range1));
+}
+
+cv::Mat sumHistograms(const std::vector<cv::Mat>& histograms) {
+    cv::Mat sum;
+    for (const cv::Mat& histogram : histograms) {
+        if (sum.empty())
+            sum = histogram.clone();
+        else
+            sum += histogram;
+    }
+    return sum;
+}
+
+IncrementalHistogram::IncrementalHistogram(const cv::Mat& image, int channel, int bins, cv::Range range)
+    : current(image.clone()), channel(channel), bins(bins), range(range), counts(bins, 0) {
+    HistogramLayout layout(channel, bins, range);
+    checkInput(current, cv::Mat(), layout);
+    countRows(current, cv::Mat(), cv::Range(0, current.rows), layout, counts.data());
+}
+
+void IncrementalHistogram::updateRoi(const cv::Rect& roi, const cv::Mat& pixels) {
+    CV_Assert(pixels.size() == roi.size() && pixels.type() == current.type());
+    CV_Assert((roi & cv::Rect(0, 0, current.cols, current.rows)) == roi);
+    HistogramLayout layout(channel, bins, range);
+
+    // Unsigned arithmetic wraps around, so adding new - old per bin is exact
+    std::vector<uint32_t> removed(bins, 0), added(bins, 0);
+    cv::Mat region = current(roi);
+    countRows(region, cv::Mat(), cv::Range(0, region.rows), layout, removed.data());
+    countRows(pixels, cv::Mat(), cv::Range(0, pixels.rows), layout, added.data());
+    for (int i = 0; i < bins; ++i)
+        counts[i] += added[i] - removed[i];
+
+    pixels.copyTo(region);
+}
+
+cv::Mat IncrementalHistogram::histogram() const {
+    return toHistogramMat(counts, HistogramLayout(channel, bins, range));
+}
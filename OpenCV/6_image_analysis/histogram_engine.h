@@ -0,0 +1,52 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// Histograms of 8-bit images for high-volume statistics. Every thread counts its rows into private histograms,
+// which are merged at the end, so the threads never share a counter. Inside a thread, consecutive pixels go to
+// 4 interleaved sub-histograms: runs of equal values (flat image areas) would otherwise increment the same counter
+// again before the previous increment is stored, and every pixel would wait for the previous one.
+// Results are CV_32F matrices laid out like the ones of cv::calcHist with uniform bins. As in calcHist, every channel
+// has a value range [start, end) that is split into the bins, and values outside of it are not counted; 8-bit hue
+// (cv::COLOR_BGR2HSV) for example only goes up to 179 and needs cv::Range(0, 180).
+
+// Histogram of one channel: bins x 1
+cv::Mat histogram1D(const cv::Mat& image, int channel = 0, int bins = 256, const cv::Mat& mask = cv::Mat(),
+                    cv::Range range = cv::Range(0, 256));
+
+// Joint histogram of two channels (e.g. hue and saturation): bins0 x bins1
+cv::Mat histogram2D(const cv::Mat& image, int channel0, int channel1, int bins0 = 32, int bins1 = 32,
+                    const cv::Mat& mask = cv::Mat(), cv::Range range0 = cv::Range(0, 256),
+                    cv::Range range1 = cv::Range(0, 256));
+
+// One histogram per image; for many small images it is cheaper to give every thread whole images
+std::vector<cv::Mat> histograms1D(const std::vector<cv::Mat>& images, int channel = 0, int bins = 256,
+                                  cv::Range range = cv::Range(0, 256));
+std::vector<cv::Mat> histograms2D(const std::vector<cv::Mat>& images, int channel0, int channel1,
+                                  int bins0 = 32, int bins1 = 32, cv::Range range0 = cv::Range(0, 256),
+                                  cv::Range range1 = cv::Range(0, 256));
+
+// Histogram of a set of images taken together
+cv::Mat sumHistograms(const std::vector<cv::Mat>& histograms);
+
+// Histogram of an image that changes in regions, e.g. a frame where only an overlay or a tile is updated.
+// Keeps a copy of the image, so an update only recounts the pixels of the changed region.
+class IncrementalHistogram {
+public:
+    explicit IncrementalHistogram(const cv::Mat& image, int channel = 0, int bins = 256,
+                                  cv::Range range = cv::Range(0, 256));
+
+    // Replaces the pixels inside roi by `pixels` (of size roi.size()): their old values are removed from the
+    // counts and the new ones added
+    void updateRoi(const cv::Rect& roi, const cv::Mat& pixels);
+
+    cv::Mat histogram() const;  // bins x 1 CV_32F
+    const cv::Mat& image() const { return current; }
+
+private:
+    cv::Mat current;
+    int channel, bins;
+    cv::Range range;
+    std::vector<uint32_t> counts;
+};
@@ -0,0 +1,122 @@
+#include "image_analysis.h"
+#include "histogram_engine.h"
+#include <algorithm>
+
+// Splits the rows into one band per thread, but never into bands shorter than minRows
+static std::vector<cv::Range> rowBands(int rows, int minRows) {
+    const int threads = std::max(1, cv::getNumThreads());
+    const int bandRows = std::max(std::max(1, minRows), (rows + threads - 1) / threads);
+    std::vector<cv::Range> bands;
+    for (int y0 = 0; y0 < rows; y0 += bandRows)
+        bands.emplace_back(y0, std::min(rows, y0 + bandRows));
+    return bands;
+}
+
+void harrisResponse(const cv::Mat& gray, cv::Mat& response, int blockSize, int ksize, double k) {
+    CV_Assert(!gray.empty() && gray.channels() == 1 && ksize > 0);
+    response.create(gray.size(), CV_32F);
+
+    // Sobel reaches ksize / 2 rows, the covariance sum blockSize / 2 more; rows closer than that to a cut
+    // would see the extrapolated border instead of the real neighbours, so they are computed but thrown away
+    const int halo = ksize / 2 + blockSize / 2 + 1;
+    const std::vector<cv::Range> bands = rowBands(gray.rows, 4 * halo);
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(bands.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const cv::Range& band = bands[i];
+            int start = std::max(0, band.start - halo);
+            int end = std::min(gray.rows, band.end + halo);
+
+            cv::Mat bandResponse;
+            cv::cornerHarris(gray.rowRange(start, end), bandResponse, blockSize, ksize, k);
+            cv::Mat output = response.rowRange(band.start, band.end);
+            bandResponse.rowRange(band.start - start, band.end - start).copyTo(output);
+        }
+    });
+}
+
+std::vector<cv::Point> harrisCorners(const cv::Mat& gray, double qualityLevel, int blockSize, int ksize, double k) {
+    cv::Mat response;
+    harrisResponse(gray, response, blockSize, ksize, k);
+
+    double strongest = 0;
+    cv::minMaxLoc(response, nullptr, &strongest);
+    if (strongest <= 0)
+        return {};
+
+    // A corner is the maximum of its 3x3 neighbourhood and strong enough
+    cv::Mat localMax;
+    cv::dilate(response, localMax, cv::Mat());
+    cv::Mat corners = (response == localMax) & (response > qualityLevel * strongest);
+
+    std::vector<cv::Point> points;
+    cv::findNonZero(corners, points);
+    return points;
+}
+
+std::vector<std::vector<cv::Point>> extractContours(const cv::Mat& binary) {
+    CV_Assert(!binary.empty() && binary.type() == CV_8UC1);
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    return contours;
+}
+
+cv::Mat channelHistogram(const cv::Mat& image, int channel, int bins, const cv::Mat& mask) {
+    return histogram1D(image, channel, bins, mask);
+}
+
+std::vector<ShapeMeasurements> measureShapes(const std::vector<std::vector<cv::Point>>& contours) {
+    std::vector<ShapeMeasurements> shapes(contours.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(contours.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            const std::vector<cv::Point>& contour = contours[i];
+            ShapeMeasurements& shape = shapes[i];
+            shape.area = cv::contourArea(contour);
+            shape.perimeter = cv::arcLength(contour, true);
+            shape.boundingBox = cv::boundingRect(contour);
+            cv::minEnclosingCircle(contour, shape.circleCenter, shape.circleRadius);
+            if (contour.size() >= 5) {
+                shape.ellipse = cv::fitEllipse(contour);
+                shape.hasEllipse = true;
+            }
+            shape.hu = huMoments(cv::moments(contour));
+        }
+    });
+    return shapes;
+}
+
+cv::Moments imageMoments(const cv::Mat& image, bool binaryImage) {
+    CV_Assert(!image.empty() && image.channels() == 1);
+    const std::vector<cv::Range> bands = rowBands(image.rows, 64);
+    std::vector<cv::Moments> bandMoments(bands.size());
+    cv::parallel_for_(cv::Range(0, static_cast<int>(bands.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i)
+            bandMoments[i] = cv::moments(image.rowRange(bands[i]), binaryImage);
+    });
+
+    // The moments of a band use y relative to its first row; with y = y' + t:
+    // sum x^p (y' + t)^q = sum_k C(q, k) t^(q - k) m'_pk
+    double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0, m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+    for (size_t i = 0; i < bands.size(); ++i) {
+        const cv::Moments& b = bandMoments[i];
+        const double t = bands[i].start;
+        m00 += b.m00;
+        m10 += b.m10;
+        m01 += b.m01 + t * b.m00;
+        m20 += b.m20;
+        m11 += b.m11 + t * b.m10;
+        m02 += b.m02 + 2 * t * b.m01 + t * t * b.m00;
+        m30 += b.m30;
+        m21 += b.m21 + t * b.m20;
+        m12 += b.m12 + 2 * t * b.m11 + t * t * b.m10;
+        m03 += b.m03 + 3 * t * b.m02 + 3 * t * t * b.m01 + t * t * t * b.m00;
+    }
+    // This constructor derives the central and normalized moments
+    return cv::Moments(m00, m10, m01, m20, m11, m02, m30, m21, m12, m03);
+}
+
+std::array<double, 7> huMoments(const cv::Moments& moments) {
+    std::array<double, 7> hu{};
+    cv::HuMoments(moments, hu.data());
+    return hu;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <vector>
+
+// Image analysis operations of chapter 6. The per-pixel operations split the image into horizontal bands that
+// are processed in parallel with cv::parallel_for_; their results are identical to the single OpenCV call.
+
+// Harris response, same as cv::cornerHarris(gray, response, blockSize, ksize, k) with the default border.
+// Every band is computed with enough extra rows around it that the filters see the same neighbourhoods.
+void harrisResponse(const cv::Mat& gray, cv::Mat& response, int blockSize = 2, int ksize = 3, double k = 0.04);
+
+// Local maxima (3x3) of the Harris response that are above qualityLevel times the strongest response
+std::vector<cv::Point> harrisCorners(const cv::Mat& gray, double qualityLevel = 0.01, int blockSize = 2,
+                                     int ksize = 3, double k = 0.04);
+
+// Outer contours of a binary image (cv::findContours with RETR_EXTERNAL and CHAIN_APPROX_SIMPLE).
+// Contour following has to cross band borders, so this runs on the whole image; the contours are then
+// measured in parallel (measureShapes) and whole images are analysed in parallel (analysis_batch.h).
+std::vector<std::vector<cv::Point>> extractContours(const cv::Mat& binary);
+
+// Histogram of one channel of an 8-bit image, as cv::calcHist with the range [0, 256): a bins x 1 CV_32F matrix.
+// Counted by the privatized histogram engine (histogram_engine.h).
+cv::Mat channelHistogram(const cv::Mat& image, int channel = 0, int bins = 256, const cv::Mat& mask = cv::Mat());
+
+// Geometric description of one contour
+struct ShapeMeasurements {
+    double area = 0;
+    double perimeter = 0;
+    cv::Rect boundingBox;
+    cv::Point2f circleCenter;     // Minimum enclosing circle
+    float circleRadius = 0;
+    bool hasEllipse = false;      // fitEllipse needs at least 5 points
+    cv::RotatedRect ellipse;
+    std::array<double, 7> hu{};   // Hu moments of the contour
+};
+
+// Measures every contour; the contours are distributed over the threads
+std::vector<ShapeMeasurements> measureShapes(const std::vector<std::vector<cv::Point>>& contours);
+
+// Moments of a single-channel image, same as cv::moments(image, binaryImage). The raw moments of every band are
+// computed in parallel, moved from band to image coordinates and added up.
+cv::Moments imageMoments(const cv::Mat& image, bool binaryImage = false);
+
+std::array<double, 7> huMoments(const cv::Moments& moments);
@@ -0,0 +1,61 @@
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include "frame_pipeline.h"
+#include "object_tracker.h"
+
+int main() {
+    cv::VideoCapture cap(0); // Open the default camera
+    if (!cap.isOpened()) {
+        std::cerr << "Error opening video stream" << std::endl;
+        return -1;
+    }
+
+    // Red object; see TrackerOptions for the tracking mode parameters. Frames larger than VGA (HD, 4K) are searched
+    // reduced to fit into 640x480, and only the box of the tracked object is refined at full resolution.
+    TrackerOptions options;
+    options.analysisSize = cv::Size(640, 480);
+    ObjectTracker tracker(options);
+
+    // Capture runs on its own thread; the tracker needs the frames in order, so it runs in the sink
+    FramePipeline pipeline(1, 4);
+    cv::Mat display;
+    pipeline.run(
+            [&](cv::Mat& frame) {
+                cap >> frame;
+                return !frame.empty();
+            },
+            [] {
+                return [](const cv::Mat& frame, cv::Mat& result) { result = frame; };
+            },
+            [&](const FramePacket& packet) {
+                const TrackerResult& result = tracker.process(packet.source);
+
+                // Searched region in yellow, all objects found in it in green, the tracked one in red
+                packet.source.copyTo(display);
+                cv::rectangle(display, result.searchWindow, cv::Scalar(0, 255, 255), 1);
+                for (const cv::Rect& rect : result.detections)
+                    cv::rectangle(display, rect, cv::Scalar(0, 255, 0), 2);
+                if (result.tracking) {
+                    cv::rectangle(display, result.target, cv::Scalar(0, 0, 255), result.found ? 2 : 1);
+                    cv::Point center(result.target.x + result.target.width / 2, result.target.y + result.target.height / 2);
+                    cv::circle(display, center, 5, cv::Scalar(255, 0, 0), -1);
+                }
+
+                // Show the frame and the mask of the searched region
+                cv::imshow("Object Tracking", display);
+                cv::imshow("Mask", tracker.mask());
+
+                if (packet.index % 100 == 99)
+                    std::cout << tracker.stats() << std::endl;
+
+                // Exit on ESC key
+                return cv::waitKey(10) != 27;
+            });
+
+    std::cout << tracker.stats() << std::endl;
+
+    // Cleanup
+    cap.release();
+    cv::destroyAllWindows();
+    return 0;
+}
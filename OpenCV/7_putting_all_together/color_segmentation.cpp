@@ -0,0 +1,111 @@
+#include "color_segmentation.h"
+#include <bit>
+
+// Cells of the coarse table: the 5 high bits of every channel
+static inline int cellIndex(int b, int g, int r) {
+    return (b >> 3) << 10 | (g >> 3) << 5 | (r >> 3);
+}
+
+ColorRangeMask::ColorRangeMask(const cv::Scalar& lowerHsv, const cv::Scalar& upperHsv) {
+    addRange(lowerHsv, upperHsv);
+}
+
+void ColorRangeMask::addRange(const cv::Scalar& lowerHsv, const cv::Scalar& upperHsv) {
+    if (lowerHsv[0] > upperHsv[0]) {
+        // Hue wraps around: [lower, 179] and [0, upper]
+        ranges.push_back({lowerHsv, cv::Scalar(179, upperHsv[1], upperHsv[2])});
+        ranges.push_back({cv::Scalar(0, lowerHsv[1], lowerHsv[2]), upperHsv});
+    } else {
+        ranges.push_back({lowerHsv, upperHsv});
+    }
+    built = false;
+}
+
+void ColorRangeMask::clear() {
+    ranges.clear();
+    built = false;
+}
+
+void ColorRangeMask::build() {
+    // Exact answer for all 2^24 colors, one bit per color at b << 16 | g << 8 | r. Every blue value is a
+    // 256 x 256 image of all green/red combinations, converted and thresholded by OpenCV.
+    std::vector<uint64_t> exact(1 << 18, 0);
+    cv::parallel_for_(cv::Range(0, 256), [&](const cv::Range& blues) {
+        cv::Mat plane(256, 256, CV_8UC3), hsv, inside, rangeMask;
+        for (int b = blues.start; b < blues.end; ++b) {
+            for (int g = 0; g < 256; ++g) {
+                uchar* p = plane.ptr<uchar>(g);
+                for (int r = 0; r < 256; ++r) {
+                    p[3 * r] = static_cast<uchar>(b);
+                    p[3 * r + 1] = static_cast<uchar>(g);
+                    p[3 * r + 2] = static_cast<uchar>(r);
+                }
+            }
+            cv::cvtColor(plane, hsv, cv::COLOR_BGR2HSV);
+            inside = cv::Mat::zeros(256, 256, CV_8UC1);
+            for (const Range& range : ranges) {
+                cv::inRange(hsv, range.lower, range.upper, rangeMask);
+                cv::bitwise_or(inside, rangeMask, inside);
+            }
+
+            uint64_t* words = exact.data() + static_cast<size_t>(b) * 1024;
+            for (int g = 0; g < 256; ++g) {
+                const uchar* in = inside.ptr<uchar>(g);
+                for (int r = 0; r < 256; ++r) {
+                    if (in[r])
+                        words[(g << 8 | r) >> 6] |= uint64_t(1) << (r & 63);
+                }
+            }
+        }
+    });
+
+    // Classify the cells; only the mixed ones keep their 512 bits (8 words: blue, then 8 bits per green, bit = red)
+    cells.assign(1 << 15, 0);
+    mixedBits.clear();
+    for (int cell = 0; cell < (1 << 15); ++cell) {
+        const int b0 = (cell >> 10) << 3, g0 = ((cell >> 5) & 31) << 3, r0 = (cell & 31) << 3;
+        std::array<uint64_t, 8> bits{};
+        int count = 0;
+        for (int db = 0; db < 8; ++db) {
+            for (int dg = 0; dg < 8; ++dg) {
+                const size_t color = static_cast<size_t>(b0 + db) << 16 | (g0 + dg) << 8 | r0;
+                const uint64_t reds = (exact[color >> 6] >> (r0 & 63)) & 0xFF;
+                bits[db] |= reds << (dg * 8);
+                count += std::popcount(reds);
+            }
+        }
+        if (count == 512) {
+            cells[cell] = 1;
+        } else if (count > 0) {
+            cells[cell] = static_cast<uint16_t>(mixedBits.size() + 2);
+            mixedBits.push_back(bits);
+        }
+    }
+    built = true;
+}
+
+void ColorRangeMask::apply(const cv::Mat& bgr, cv::Mat& mask) {
+    CV_Assert(!bgr.empty() && bgr.type() == CV_8UC3);
+    if (!built)
+        build();
+    mask.create(bgr.size(), CV_8UC1);
+
+    const uint16_t* table = cells.data();
+    const std::array<uint64_t, 8>* mixed = mixedBits.data();
+    cv::parallel_for_(cv::Range(0, bgr.rows), [&](const cv::Range& rows) {
+        for (int y = rows.start; y < rows.end; ++y) {
+            const uchar* p = bgr.ptr<uchar>(y);
+            uchar* out = mask.ptr<uchar>(y);
+            for (int x = 0; x < bgr.cols; ++x, p += 3) {
+                const int b = p[0], g = p[1], r = p[2];
+                const uint16_t cell = table[cellIndex(b, g, r)];
+                bool inside = cell == 1;
+                if (cell >= 2) {
+                    const uint64_t word = mixed[cell - 2][b & 7];
+                    inside = (word >> ((g & 7) * 8 + (r & 7))) & 1;
+                }
+                out[x] = inside ? 255 : 0;
+            }
+        }
+    });
+}
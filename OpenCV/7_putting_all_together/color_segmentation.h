@@ -0,0 +1,37 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// Thresholds a BGR image against HSV ranges in one pass, without converting it to HSV first.
+// cvtColor(BGR2HSV) + inRange writes a three-channel image only to read it back and throw it away; here every BGR
+// color is looked up in a table built once from the ranges:
+//  * a 32x32x32 table over the 5 high bits of B, G and R says whether all 512 colors of a cell are inside, all
+//    outside, or mixed; it fits into the L2 cache and decides most pixels,
+//  * for the mixed cells at the borders of the ranges, a 512-bit set holds the exact answer per color.
+// The table is built with cv::cvtColor and cv::inRange themselves, so the mask is identical to theirs.
+class ColorRangeMask {
+public:
+    ColorRangeMask() = default;
+    // A single range, see addRange
+    ColorRangeMask(const cv::Scalar& lowerHsv, const cv::Scalar& upperHsv);
+
+    // Adds an HSV range (8-bit HSV: hue 0..179) of colors to accept. A range whose lower hue is greater than its
+    // upper hue wraps around 0, e.g. red from 170 to 10.
+    void addRange(const cv::Scalar& lowerHsv, const cv::Scalar& upperHsv);
+    void clear();
+
+    // 255 where the BGR color falls into any of the ranges, 0 elsewhere; the table is rebuilt after addRange
+    void apply(const cv::Mat& bgr, cv::Mat& mask);
+
+private:
+    void build();
+
+    struct Range { cv::Scalar lower, upper; };
+    std::vector<Range> ranges;
+    bool built = false;
+    // 0 = cell outside, 1 = inside, n >= 2: exact bits in mixedBits[n - 2]
+    std::vector<uint16_t> cells;
+    std::vector<std::array<uint64_t, 8>> mixedBits;
+};
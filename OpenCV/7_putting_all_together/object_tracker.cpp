@@ -0,0 +1,161 @@
+#include "object_tracker.h"
+#include <algorithm>
+#include <cmath>
+#include "connected_blobs.h"
+
+std::ostream& operator<<(std::ostream& os, const TrackerStats& stats) {
+    os << "frames: " << stats.frames << ", full scans: " << stats.fullScans << ", pixels searched: "
+       << (stats.pixelsTotal ? 100.0 * stats.pixelsSearched / stats.pixelsTotal : 0.0) << "%";
+    return os;
+}
+
+static cv::Point2f center(const cv::Rect& box) {
+    return cv::Point2f(box.x + box.width * 0.5f, box.y + box.height * 0.5f);
+}
+
+ObjectTracker::ObjectTracker(const TrackerOptions& options)
+    : options(options), kalman(4, 2, 0, CV_32F), colorRange(options.lower, options.upper),
+      scaler(options.analysisSize) {
+    // State (x, y, vx, vy), measurement (x, y), one frame per step
+    kalman.transitionMatrix = (cv::Mat_<float>(4, 4) <<
+            1, 0, 1, 0,
+            0, 1, 0, 1,
+            0, 0, 1, 0,
+            0, 0, 0, 1);
+    cv::setIdentity(kalman.measurementMatrix);
+    cv::setIdentity(kalman.processNoiseCov, cv::Scalar(1e-2));
+    cv::setIdentity(kalman.measurementNoiseCov, cv::Scalar(1e-1));
+}
+
+void ObjectTracker::startTrack(const cv::Rect& box) {
+    const cv::Point2f c = center(box);
+    kalman.statePost = (cv::Mat_<float>(4, 1) << c.x, c.y, 0, 0);
+    cv::setIdentity(kalman.errorCovPost);
+    tracking = true;
+    missed = 0;
+    objectSize = box.size();
+}
+
+cv::Rect ObjectTracker::predictedWindow(const cv::Point2f& c, const cv::Size& frameSize) const {
+    const int width = cvRound(objectSize.width * options.searchScale) + 2 * options.searchMargin;
+    const int height = cvRound(objectSize.height * options.searchScale) + 2 * options.searchMargin;
+    cv::Rect window(cvRound(c.x - width * 0.5f), cvRound(c.y - height * 0.5f), width, height);
+    return window & cv::Rect(0, 0, frameSize.width, frameSize.height);
+}
+
+std::vector<cv::Rect> ObjectTracker::detect(const cv::Mat& frame, const cv::Rect& window, int minArea,
+                                            cv::Mat& colorBuffer, cv::Mat& maskBuffer) {
+    // Same steps as 7.2, restricted to the window; the HSV conversion and the threshold are one table lookup
+    colorRange.apply(frame(window), colorBuffer);
+    cv::erode(colorBuffer, maskBuffer, cv::Mat(), cv::Point(-1, -1), 2);
+    cv::dilate(maskBuffer, maskBuffer, cv::Mat(), cv::Point(-1, -1), 2);
+
+    // Only the boxes are needed, so the regions are labelled instead of tracing their contours
+    std::vector<cv::Rect> boxes;
+    for (const Blob& blob : findBlobs(maskBuffer, minArea))
+        boxes.push_back(blob.box + window.tl());
+    counters.pixelsSearched += window.area();
+    return boxes;
+}
+
+const TrackerResult& ObjectTracker::process(const cv::Mat& frame) {
+    CV_Assert(!frame.empty() && frame.type() == CV_8UC3);
+    ++counters.frames;
+    counters.pixelsTotal += static_cast<uint64_t>(frame.cols) * frame.rows;
+    last = TrackerResult();
+
+    // The search runs on the reduced frame, if any; the results are then mapped back to the full frame
+    track(scaler.downscale(frame));
+    if (scaler.scaled())
+        mapToFull(frame);
+    return last;
+}
+
+void ObjectTracker::track(const cv::Mat& frame) {
+    const cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+    const int minArea = std::max(1, cvRound(options.minArea / (scaler.scaleX() * scaler.scaleY())));
+
+    cv::Point2f predicted;
+    bool fullFrame = !tracking || ++framesSinceScan >= options.rescanInterval;
+    if (tracking) {
+        const cv::Mat& state = kalman.predict();
+        predicted = cv::Point2f(state.at<float>(0), state.at<float>(1));
+        last.searchWindow = predictedWindow(predicted, frame.size());
+        if (last.searchWindow.empty())
+            fullFrame = true;
+    }
+
+    for (;;) {
+        if (fullFrame) {
+            last.searchWindow = frameRect;
+            framesSinceScan = 0;
+            ++counters.fullScans;
+        }
+        last.fullFrame = fullFrame;
+        last.detections = detect(frame, last.searchWindow, minArea, colorMask, morphed);
+
+        if (!last.detections.empty()) {
+            if (tracking) {
+                // The detection closest to the prediction continues the track
+                auto distance = [&](const cv::Rect& box) {
+                    const cv::Point2f d = center(box) - predicted;
+                    return d.x * d.x + d.y * d.y;
+                };
+                last.target = *std::min_element(last.detections.begin(), last.detections.end(),
+                                                [&](const cv::Rect& a, const cv::Rect& b) {
+                                                    return distance(a) < distance(b);
+                                                });
+                const cv::Point2f c = center(last.target);
+                kalman.correct((cv::Mat_<float>(2, 1) << c.x, c.y));
+                missed = 0;
+                objectSize = last.target.size();
+            } else {
+                // A new track starts at the largest object
+                last.target = *std::max_element(last.detections.begin(), last.detections.end(),
+                                                [](const cv::Rect& a, const cv::Rect& b) {
+                                                    return a.area() < b.area();
+                                                });
+                startTrack(last.target);
+            }
+            last.found = true;
+            break;
+        }
+
+        if (tracking && ++missed <= options.maxMissedFrames) {
+            // Coast on the prediction for a few frames, the object may only be occluded
+            last.target = cv::Rect(cvRound(predicted.x - objectSize.width * 0.5f),
+                                   cvRound(predicted.y - objectSize.height * 0.5f),
+                                   objectSize.width, objectSize.height) & frameRect;
+            break;
+        }
+        tracking = false;
+        if (fullFrame)
+            break;
+        // The track is lost: search the whole frame right away
+        fullFrame = true;
+    }
+
+    last.tracking = tracking;
+}
+
+void ObjectTracker::mapToFull(const cv::Mat& frame) {
+    const cv::Rect reducedTarget = last.target;
+    last.searchWindow = scaler.toFull(last.searchWindow);
+    for (cv::Rect& box : last.detections)
+        box = scaler.toFull(box);
+    if (!last.tracking)
+        return;
+    last.target = scaler.toFull(reducedTarget);
+    if (!last.found)
+        return;
+
+    // Refinement: the exact box of the tracked object at full resolution, searched only around its mapped box
+    const int margin = options.refineMargin + static_cast<int>(std::ceil(std::max(scaler.scaleX(), scaler.scaleY())));
+    std::vector<cv::Rect> boxes = detect(frame, scaler.refinementRoi(reducedTarget, margin), options.minArea,
+                                         refineColorMask, refineMorphed);
+    if (!boxes.empty()) {
+        last.target = *std::max_element(boxes.begin(), boxes.end(), [](const cv::Rect& a, const cv::Rect& b) {
+            return a.area() < b.area();
+        });
+    }
+}
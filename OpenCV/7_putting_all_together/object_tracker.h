@@ -0,0 +1,84 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "analysis_scaler.h"
+#include "color_segmentation.h"
+
+struct TrackerOptions {
+    // HSV range of the object color: red, as in the example of 7_putting_all_together.md.
+    // A lower hue above the upper hue wraps around hue 0, e.g. 170..10 for the whole red band.
+    cv::Scalar lower{0, 120, 70};
+    cv::Scalar upper{10, 255, 255};
+    int minArea = 100;          // Smaller blobs (pixels) are noise
+    int rescanInterval = 30;    // Frames between full-frame scans while tracking
+    double searchScale = 2.0;   // Search window = object size times this ...
+    int searchMargin = 32;      // ... plus this many pixels on every side
+    int maxMissedFrames = 3;    // Frames the object may be missing from its window before the track is lost
+    // Frames are reduced to fit into this size for the search, empty = full resolution. Search windows and
+    // margins are then in reduced pixels; the box of the tracked object is refined at full resolution.
+    cv::Size analysisSize;
+    int refineMargin = 4;       // Full-resolution pixels around the mapped box searched by the refinement
+};
+
+// What the tracker found in one frame
+struct TrackerResult {
+    bool found = false;              // The object was detected in this frame
+    bool tracking = false;           // A track exists (found, or predicted while missing)
+    bool fullFrame = false;          // The whole frame was searched
+    // All in full-resolution coordinates
+    cv::Rect target;                 // Detected box, or the predicted box while the object is missing
+    cv::Rect searchWindow;           // Region that was searched
+    std::vector<cv::Rect> detections;  // All objects in the searched region
+};
+
+struct TrackerStats {
+    uint64_t frames = 0;
+    uint64_t fullScans = 0;
+    uint64_t pixelsSearched = 0;  // Pixels actually processed, reduced or full resolution
+    uint64_t pixelsTotal = 0;     // Full-resolution pixels of all frames
+};
+
+std::ostream& operator<<(std::ostream& os, const TrackerStats& stats);
+
+// Color object tracker of chapter 7 (HSV threshold -> erode/dilate -> contours) with a tracking mode.
+// Once the object is found, a constant-velocity Kalman filter predicts its next position, and only a window
+// around the prediction is segmented. The whole frame is scanned again every rescanInterval frames (to pick up new
+// objects) and when the object has been missing from its window for more than maxMissedFrames frames.
+// For a small object in a large field of view, most frames only process a few percent of the pixels.
+class ObjectTracker {
+public:
+    explicit ObjectTracker(const TrackerOptions& options = TrackerOptions());
+
+    // BGR frames, in order
+    const TrackerResult& process(const cv::Mat& frame);
+
+    const TrackerResult& result() const { return last; }
+    // Cleaned-up mask of the last searched region (searchWindow), at the resolution it was searched in. The
+    // full-resolution refinement of the box uses buffers of its own and does not show up here
+    const cv::Mat& mask() const { return morphed; }
+    const TrackerStats& stats() const { return counters; }
+
+private:
+    // Segments the window into colorBuffer and the cleaned-up maskBuffer
+    std::vector<cv::Rect> detect(const cv::Mat& frame, const cv::Rect& window, int minArea, cv::Mat& colorBuffer,
+                                 cv::Mat& maskBuffer);
+    void track(const cv::Mat& frame);
+    void mapToFull(const cv::Mat& frame);
+    cv::Rect predictedWindow(const cv::Point2f& center, const cv::Size& frameSize) const;
+    void startTrack(const cv::Rect& box);
+
+    TrackerOptions options;
+    cv::KalmanFilter kalman;
+    bool tracking = false;
+    int missed = 0;
+    int framesSinceScan = 0;
+    cv::Size objectSize;
+    TrackerResult last;
+    TrackerStats counters;
+    ColorRangeMask colorRange;
+    AnalysisScaler scaler;
+    cv::Mat colorMask, morphed;              // Search of the last frame, reused between frames
+    cv::Mat refineColorMask, refineMorphed;  // Full-resolution refinement, kept apart so mask() shows the search
+};
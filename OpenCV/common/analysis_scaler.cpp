@@ -0,0 +1,70 @@
+#include "analysis_scaler.h"
+#include <algorithm>
+#include <cmath>
+
+AnalysisScaler::AnalysisScaler(cv::Size analysisSize) : target(analysisSize) {
+    CV_Assert(analysisSize.width >= 0 && analysisSize.height >= 0);
+}
+
+const cv::Mat& AnalysisScaler::downscale(const cv::Mat& frame) {
+    full = frame.size();
+    const double factor = target.area() > 0
+            ? std::min(static_cast<double>(target.width) / frame.cols, static_cast<double>(target.height) / frame.rows)
+            : 1.0;
+    if (factor >= 1.0) {
+        fx = fy = 1.0;
+        return frame;
+    }
+
+    cv::Size size(std::max(1, cvRound(frame.cols * factor)), std::max(1, cvRound(frame.rows * factor)));
+    cv::resize(frame, reduced, size, 0, 0, cv::INTER_AREA);
+    // Exact per-axis ratios, the rounding of the reduced size makes them differ slightly
+    fx = static_cast<double>(frame.cols) / size.width;
+    fy = static_cast<double>(frame.rows) / size.height;
+    return reduced;
+}
+
+cv::Point2f AnalysisScaler::toFull(const cv::Point2f& point) const {
+    // Pixel centers: analysis pixel x covers full pixels [x * fx, (x + 1) * fx)
+    return cv::Point2f(static_cast<float>((point.x + 0.5) * fx - 0.5), static_cast<float>((point.y + 0.5) * fy - 0.5));
+}
+
+cv::Rect AnalysisScaler::toFull(const cv::Rect& box) const {
+    const int x0 = static_cast<int>(std::floor(box.x * fx));
+    const int y0 = static_cast<int>(std::floor(box.y * fy));
+    const int x1 = static_cast<int>(std::ceil((box.x + box.width) * fx));
+    const int y1 = static_cast<int>(std::ceil((box.y + box.height) * fy));
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(0, 0, full.width, full.height);
+}
+
+std::vector<cv::Point> AnalysisScaler::toFull(const std::vector<cv::Point>& contour) const {
+    std::vector<cv::Point> mapped;
+    mapped.reserve(contour.size());
+    for (const cv::Point& point : contour)
+        mapped.push_back(toFull(cv::Point2f(static_cast<float>(point.x), static_cast<float>(point.y))));
+    return mapped;
+}
+
+void AnalysisScaler::toFull(const cv::Mat& mask, cv::Mat& fullMask) const {
+    if (!scaled())
+        mask.copyTo(fullMask);
+    else
+        cv::resize(mask, fullMask, full, 0, 0, cv::INTER_NEAREST);
+}
+
+cv::Rect AnalysisScaler::toAnalysis(const cv::Rect& fullBox) const {
+    const int x0 = static_cast<int>(std::floor(fullBox.x / fx));
+    const int y0 = static_cast<int>(std::floor(fullBox.y / fy));
+    const int x1 = static_cast<int>(std::ceil((fullBox.x + fullBox.width) / fx));
+    const int y1 = static_cast<int>(std::ceil((fullBox.y + fullBox.height) / fy));
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+cv::Rect AnalysisScaler::refinementRoi(const cv::Rect& analysisBox, int margin) const {
+    cv::Rect box = toFull(analysisBox);
+    box.x -= margin;
+    box.y -= margin;
+    box.width += 2 * margin;
+    box.height += 2 * margin;
+    return box & cv::Rect(0, 0, full.width, full.height);
+}
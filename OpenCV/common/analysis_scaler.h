@@ -0,0 +1,43 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Runs analysis on a reduced copy of the frame and maps the results back to full resolution.
+// Detection and tracking rarely need every pixel of a 4K frame: downscaling with INTER_AREA (which averages the
+// source pixels, so it does not alias) to e.g. 640 pixels wide divides the cost of everything after it by ~36.
+// The boxes, points, contours and masks found there are mapped back with toFull; where full precision matters,
+// refinementRoi gives the region of the full frame around a result, so only that part is processed again.
+class AnalysisScaler {
+public:
+    // Frames are reduced to fit into analysisSize (keeping the aspect ratio); an empty size or a larger
+    // analysis size than the frame keeps the frame as it is
+    explicit AnalysisScaler(cv::Size analysisSize = cv::Size());
+
+    // Reduced copy of the frame, or the frame itself when it already fits. Sets the scale of the mapping.
+    const cv::Mat& downscale(const cv::Mat& frame);
+
+    bool scaled() const { return fx != 1.0 || fy != 1.0; }
+    // Full-resolution pixels per analysis pixel
+    double scaleX() const { return fx; }
+    double scaleY() const { return fy; }
+    cv::Size fullSize() const { return full; }
+
+    cv::Point2f toFull(const cv::Point2f& point) const;
+    // The full-resolution box covering the analysis box
+    cv::Rect toFull(const cv::Rect& box) const;
+    std::vector<cv::Point> toFull(const std::vector<cv::Point>& contour) const;
+    // Nearest-neighbour upscaling, so a binary mask stays binary
+    void toFull(const cv::Mat& mask, cv::Mat& fullMask) const;
+
+    cv::Rect toAnalysis(const cv::Rect& fullBox) const;
+
+    // Full-resolution region around an analysis box, with `margin` full-resolution pixels around it to make up
+    // for the precision lost in the reduced frame, clipped to the frame
+    cv::Rect refinementRoi(const cv::Rect& analysisBox, int margin) const;
+
+private:
+    cv::Size target;
+    cv::Size full;
+    double fx = 1.0, fy = 1.0;
+    cv::Mat reduced;
+};
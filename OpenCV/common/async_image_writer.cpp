@@ -0,0 +1,129 @@
+#include "async_image_writer.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+std::ostream& operator<<(std::ostream& os, const std::map<std::string, ImageFormatStats>& stats) {
+    for (const auto& [format, s] : stats) {
+        os << format << ": " << s.images << " images (" << s.failed << " failed), encode "
+           << (s.images ? s.encodeMs / s.images : 0.0) << " ms/image, " << s.encodedBytes / 1e6 << " MB, ratio "
+           << s.compressionRatio() << std::endl;
+    }
+    return os;
+}
+
+static std::string formatOf(const std::string& path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (!extension.empty())
+        extension.erase(0, 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == "jpeg" ? "jpg" : extension;
+}
+
+AsyncImageWriter::AsyncImageWriter(size_t workers, size_t memoryBudget)
+    : memoryBudget(memoryBudget), pool(workers) {
+    defaultParams["png"] = {cv::IMWRITE_PNG_COMPRESSION, 1};
+    defaultParams["jpg"] = {cv::IMWRITE_JPEG_QUALITY, 90};
+    defaultParams["webp"] = {cv::IMWRITE_WEBP_QUALITY, 90};
+}
+
+AsyncImageWriter::~AsyncImageWriter() {
+    wait();
+}
+
+void AsyncImageWriter::setDefaultParams(const std::string& format, const std::vector<int>& params) {
+    std::lock_guard<std::mutex> lock(mutex);
+    defaultParams[format] = params;
+}
+
+std::future<ImageWriteResult> AsyncImageWriter::write(const cv::Mat& image, const std::string& path,
+                                                      const std::vector<int>& params) {
+    const size_t bytes = image.total() * image.elemSize();
+    const std::string format = formatOf(path);
+    std::vector<int> encoderParams = params;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // An image larger than the whole budget still goes through once nothing else is queued
+        changed.wait(lock, [&] { return queuedImages == 0 || queuedBytes + bytes <= memoryBudget; });
+        queuedBytes += bytes;
+        ++queuedImages;
+        if (encoderParams.empty()) {
+            auto defaults = defaultParams.find(format);
+            if (defaults != defaultParams.end())
+                encoderParams = defaults->second;
+        }
+    }
+
+    // The lambda holds a reference to the pixels, not a copy
+    return pool.submit([this, image, path, format, encoderParams, bytes] {
+        // Leaves the queue however the write ends; an exception (e.g. std::bad_alloc) reaches the future
+        struct Dequeue {
+            AsyncImageWriter* writer;
+            size_t bytes;
+            ~Dequeue() {
+                {
+                    std::lock_guard<std::mutex> lock(writer->mutex);
+                    writer->queuedBytes -= bytes;
+                    --writer->queuedImages;
+                }
+                writer->changed.notify_all();
+            }
+        } dequeue{this, bytes};
+        return encodeAndWrite(image, path, format, encoderParams);
+    });
+}
+
+ImageWriteResult AsyncImageWriter::encodeAndWrite(const cv::Mat& image, const std::string& path,
+                                                  const std::string& format, const std::vector<int>& params) {
+    ImageWriteResult result;
+    result.path = path;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<uchar> encoded;
+    bool ok = false;
+    try {
+        ok = cv::imencode("." + format, image, encoded, params);
+    } catch (const cv::Exception&) {
+        ok = false;
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    result.encodeMs = elapsed.count();
+
+    if (ok) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        ok = file.good();
+    }
+    result.ok = ok;
+    result.bytes = ok ? encoded.size() : 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ImageFormatStats& stats = formatStats[format];
+    if (ok) {
+        ++stats.images;
+        stats.encodeMs += result.encodeMs;
+        stats.rawBytes += image.total() * image.elemSize();
+        stats.encodedBytes += result.bytes;
+    } else {
+        ++stats.failed;
+    }
+    return result;
+}
+
+void AsyncImageWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this] { return queuedImages == 0; });
+}
+
+size_t AsyncImageWriter::pendingBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queuedBytes;
+}
+
+std::map<std::string, ImageFormatStats> AsyncImageWriter::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return formatStats;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "thread_pool.h"
+
+// Outcome of one queued write
+struct ImageWriteResult {
+    std::string path;
+    bool ok = false;
+    double encodeMs = 0;
+    size_t bytes = 0;  // Size of the encoded file
+};
+
+// Totals per file format (lower-case extension without the dot)
+struct ImageFormatStats {
+    uint64_t images = 0;
+    uint64_t failed = 0;
+    double encodeMs = 0;
+    uint64_t rawBytes = 0;      // Pixel data handed in
+    uint64_t encodedBytes = 0;  // Written to disk
+
+    double compressionRatio() const { return encodedBytes ? static_cast<double>(rawBytes) / encodedBytes : 0.0; }
+};
+
+std::ostream& operator<<(std::ostream& os, const std::map<std::string, ImageFormatStats>& stats);
+
+// Encodes and writes images on a pool of worker threads, so the thread producing them never waits for a slow encode.
+// write() does not copy the pixels: the queued cv::Mat shares them with the caller (cv::Mat is reference counted),
+// so the caller must not write into that Mat until the write has finished, but may release or reassign it.
+// The pixel data of the queued images is limited to memoryBudget bytes; write() blocks while it is exceeded, which
+// keeps a fast producer from piling up frames in memory.
+class AsyncImageWriter {
+public:
+    explicit AsyncImageWriter(size_t workers = 2, size_t memoryBudget = size_t(256) << 20);
+    // Finishes all queued writes
+    ~AsyncImageWriter();
+
+    AsyncImageWriter(const AsyncImageWriter&) = delete;
+    AsyncImageWriter& operator=(const AsyncImageWriter&) = delete;
+
+    // Queues an image; the format follows the extension of path. Without params, the defaults of the format are used.
+    std::future<ImageWriteResult> write(const cv::Mat& image, const std::string& path,
+                                        const std::vector<int>& params = std::vector<int>());
+
+    // Encoder parameters used for a format (e.g. "png") when write() gets none. Built in: PNG compression 1,
+    // JPEG quality 90, WebP quality 90.
+    void setDefaultParams(const std::string& format, const std::vector<int>& params);
+
+    // Blocks until every queued write has finished
+    void wait();
+
+    size_t pendingBytes() const;
+    std::map<std::string, ImageFormatStats> stats() const;
+
+private:
+    ImageWriteResult encodeAndWrite(const cv::Mat& image, const std::string& path, const std::string& format,
+                                    const std::vector<int>& params);
+
+    const size_t memoryBudget;
+    mutable std::mutex mutex;
+    std::condition_variable changed;
+    size_t queuedBytes = 0;
+    size_t queuedImages = 0;
+    std::map<std::string, std::vector<int>> defaultParams;
+    std::map<std::string, ImageFormatStats> formatStats;
+    // Declared last, so it is destroyed (and its queue drained) before the members the tasks use
+    ThreadPool pool;
+};
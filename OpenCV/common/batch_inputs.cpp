@@ -0,0 +1,22 @@
+#include "batch_inputs.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+std::vector<std::string> listBatchInputs(const std::string& input) {
+    std::vector<cv::String> candidates;
+    if (fs::is_directory(input))
+        cv::glob((fs::path(input) / "*").string(), candidates, false);
+    else
+        cv::glob(input, candidates, false);
+
+    std::vector<std::string> images;
+    for (const cv::String& candidate : candidates) {
+        if (fs::is_regular_file(candidate) && cv::haveImageReader(candidate))
+            images.push_back(candidate);
+    }
+    std::sort(images.begin(), images.end());
+    return images;
+}
@@ -0,0 +1,7 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Resolves a directory or glob pattern (e.g. "frames/*.jpg") into the sorted list of files OpenCV can read as images.
+// Shared by the batch modes of the examples.
+std::vector<std::string> listBatchInputs(const std::string& input);
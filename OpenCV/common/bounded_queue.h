@@ -0,0 +1,100 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Snapshot of the counters of a BoundedQueue
+struct QueueStats {
+    size_t depth = 0;          // Items currently waiting
+    size_t capacity = 0;
+    size_t highWaterMark = 0;  // Largest depth seen so far
+    uint64_t pushed = 0;       // Items that went through the queue
+    uint64_t fullWaits = 0;    // Times a producer had to wait for space (backpressure)
+    uint64_t emptyWaits = 0;   // Times a consumer had to wait for an item (starvation)
+};
+
+// Fixed-size ring buffer shared between producer and consumer threads.
+// push() blocks while the queue is full, so a fast producer is slowed down to the pace of its consumers.
+// After close() no more items are accepted; consumers still receive the items already queued.
+template<typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : slots(capacity > 0 ? capacity : 1) {}
+
+    // Returns false if the queue was closed before the item could be stored
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (count == slots.size() && !closed)
+            ++counters.fullWaits;
+        notFull.wait(lock, [this] { return count < slots.size() || closed; });
+        if (closed)
+            return false;
+
+        slots[(head + count) % slots.size()] = std::move(item);
+        ++count;
+        ++counters.pushed;
+        counters.highWaterMark = std::max(counters.highWaterMark, count);
+        lock.unlock();
+        notEmpty.notify_one();
+        return true;
+    }
+
+    // Returns false once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (count == 0 && !closed)
+            ++counters.emptyWaits;
+        notEmpty.wait(lock, [this] { return count > 0 || closed; });
+        if (count == 0)
+            return false;
+
+        item = std::move(slots[head]);
+        slots[head] = T();
+        head = (head + 1) % slots.size();
+        --count;
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+
+    // Drops every queued item, e.g. when the pipeline is aborted
+    void clear() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (; count > 0; --count) {
+                slots[head] = T();
+                head = (head + 1) % slots.size();
+            }
+        }
+        notFull.notify_all();
+    }
+
+    QueueStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        QueueStats result = counters;
+        result.depth = count;
+        result.capacity = slots.size();
+        return result;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::condition_variable notFull, notEmpty;
+    std::vector<T> slots;
+    size_t head = 0;
+    size_t count = 0;
+    bool closed = false;
+    QueueStats counters;
+};
@@ -0,0 +1,28 @@
+#include "connected_blobs.h"
+
+std::vector<Blob> findBlobs(const cv::Mat& binary, cv::Mat& labels, int minArea, int connectivity) {
+    CV_Assert(!binary.empty() && binary.type() == CV_8UC1);
+    cv::Mat stats, centroids;
+    const int count = cv::connectedComponentsWithStats(binary, labels, stats, centroids, connectivity, CV_32S,
+                                                       cv::CCL_BBDT);
+
+    // Label 0 is the background
+    std::vector<Blob> blobs;
+    for (int label = 1; label < count; ++label) {
+        const int* s = stats.ptr<int>(label);
+        if (s[cv::CC_STAT_AREA] < minArea)
+            continue;
+        Blob blob;
+        blob.label = label;
+        blob.area = s[cv::CC_STAT_AREA];
+        blob.box = cv::Rect(s[cv::CC_STAT_LEFT], s[cv::CC_STAT_TOP], s[cv::CC_STAT_WIDTH], s[cv::CC_STAT_HEIGHT]);
+        blob.centroid = cv::Point2d(centroids.at<double>(label, 0), centroids.at<double>(label, 1));
+        blobs.push_back(blob);
+    }
+    return blobs;
+}
+
+std::vector<Blob> findBlobs(const cv::Mat& binary, int minArea, int connectivity) {
+    cv::Mat labels;
+    return findBlobs(binary, labels, minArea, connectivity);
+}
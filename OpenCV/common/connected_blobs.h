@@ -0,0 +1,19 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// A connected white region of a binary mask
+struct Blob {
+    int label = 0;          // Value of its pixels in the label image
+    int area = 0;           // Pixels
+    cv::Rect box;
+    cv::Point2d centroid;
+};
+
+// Connected regions of a binary mask (non-zero = foreground) with their area, bounding box and centroid.
+// cv::connectedComponentsWithStats labels the mask with block-based union-find (BBDT for 8-connectivity,
+// SAUF for 4), in parallel over horizontal stripes whose labels are merged at the stripe borders, and gathers
+// the statistics in the same pass. Unlike findContours + boundingRect, no contour or hierarchy is built.
+// Blobs smaller than minArea are skipped; the others are ordered by label, i.e. by their first row.
+std::vector<Blob> findBlobs(const cv::Mat& binary, cv::Mat& labels, int minArea = 0, int connectivity = 8);
+std::vector<Blob> findBlobs(const cv::Mat& binary, int minArea = 0, int connectivity = 8);
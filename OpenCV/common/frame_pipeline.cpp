@@ -0,0 +1,154 @@
+#include "frame_pipeline.h"
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::ostream& printQueue(std::ostream& os, const char* name, const QueueStats& queue) {
+    return os << name << " " << queue.depth << "/" << queue.capacity
+              << " (max " << queue.highWaterMark << ", full waits " << queue.fullWaits
+              << ", empty waits " << queue.emptyWaits << ")";
+}
+
+std::ostream& operator<<(std::ostream& os, const PipelineStats& stats) {
+    os << "frames decoded " << stats.framesDecoded << ", processed " << stats.framesProcessed
+       << ", delivered " << stats.framesDelivered << " | ";
+    printQueue(os, "decode queue", stats.decodeQueue) << " | ";
+    printQueue(os, "result queue", stats.resultQueue) << " | ";
+    return os << "reorder buffer " << stats.reorderDepth << " (full waits " << stats.reorderWaits << ")";
+}
+
+FramePipeline::FramePipeline(size_t workers, size_t queueCapacity)
+    : workers(workers > 0 ? workers : 1), reorderWindow(2 * (queueCapacity > 0 ? queueCapacity : 1)),
+      decodeQueue(queueCapacity), resultQueue(queueCapacity) {}
+
+void FramePipeline::run(const Source& source, const ProcessorFactory& makeProcessor, const Sink& sink) {
+    std::atomic<bool> stopping{false};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    // Next frame the sink waits for; a worker holds a frame until it is less than reorderWindow frames ahead
+    std::mutex reorderMutex;
+    std::condition_variable reorderChanged;
+    uint64_t nextIndex = 0;
+
+    // Wakes up every stage and drops the frames still queued
+    auto stopAll = [&] {
+        {
+            std::lock_guard<std::mutex> lock(reorderMutex);
+            stopping = true;
+        }
+        reorderChanged.notify_all();
+        decodeQueue.close();
+        decodeQueue.clear();
+        resultQueue.close();
+    };
+    auto fail = [&](std::exception_ptr exception) {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = exception;
+        }
+        stopAll();
+    };
+
+    // Decode stage
+    std::thread decoder([&] {
+        try {
+            for (uint64_t index = 0; !stopping; ++index) {
+                FramePacket packet;
+                packet.index = index;
+                if (!source(packet.source))
+                    break;
+                ++framesDecoded;
+                if (!decodeQueue.push(std::move(packet)))
+                    break;
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+        decodeQueue.close();
+    });
+
+    // Processing stage; the last worker to finish tells the sink that no more frames will come
+    std::atomic<size_t> activeWorkers{workers};
+    std::vector<std::thread> workerThreads;
+    for (size_t i = 0; i < workers; ++i) {
+        workerThreads.emplace_back([&] {
+            try {
+                Processor process = makeProcessor();
+                FramePacket packet;
+                while (!stopping && decodeQueue.pop(packet)) {
+                    process(packet.source, packet.result);
+                    ++framesProcessed;
+                    {
+                        // Frames are taken in order, so the one the sink waits for is never held here
+                        std::unique_lock<std::mutex> lock(reorderMutex);
+                        auto inWindow = [&] { return stopping || packet.index < nextIndex + reorderWindow; };
+                        if (!inWindow()) {
+                            ++reorderWaits;
+                            reorderChanged.wait(lock, inWindow);
+                        }
+                    }
+                    if (stopping || !resultQueue.push(std::move(packet)))
+                        break;
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            if (--activeWorkers == 0)
+                resultQueue.close();
+        });
+    }
+
+    // Sink stage on the calling thread; frames finishing out of order wait in the reorder buffer
+    std::map<uint64_t, FramePacket> pending;
+    uint64_t delivered = 0;
+    bool keepRunning = true;
+    try {
+        FramePacket packet;
+        while (keepRunning && resultQueue.pop(packet)) {
+            pending.emplace(packet.index, std::move(packet));
+            const uint64_t deliveredBefore = delivered;
+            for (auto it = pending.find(delivered); keepRunning && it != pending.end(); it = pending.find(delivered)) {
+                keepRunning = sink(it->second);
+                pending.erase(it);
+                ++delivered;
+                ++framesDelivered;
+            }
+            reorderDepth = pending.size();
+            if (delivered != deliveredBefore) {
+                {
+                    std::lock_guard<std::mutex> lock(reorderMutex);
+                    nextIndex = delivered;
+                }
+                reorderChanged.notify_all();
+            }
+        }
+    } catch (...) {
+        fail(std::current_exception());
+    }
+    if (!keepRunning)
+        stopAll();
+
+    decoder.join();
+    for (std::thread& worker : workerThreads)
+        worker.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+PipelineStats FramePipeline::stats() const {
+    PipelineStats result;
+    result.decodeQueue = decodeQueue.stats();
+    result.resultQueue = resultQueue.stats();
+    result.reorderDepth = reorderDepth;
+    result.reorderWaits = reorderWaits;
+    result.framesDecoded = framesDecoded;
+    result.framesProcessed = framesProcessed;
+    result.framesDelivered = framesDelivered;
+    return result;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include "bounded_queue.h"
+
+// A frame travelling through the pipeline
+struct FramePacket {
+    uint64_t index = 0;  // Position in the input stream
+    cv::Mat source;      // Frame as delivered by the decode stage
+    cv::Mat result;      // Output of the processing stage
+};
+
+// Counters of all stages, safe to read while the pipeline runs
+struct PipelineStats {
+    QueueStats decodeQueue;   // Decoded frames waiting for a worker
+    QueueStats resultQueue;   // Processed frames waiting for the sink
+    size_t reorderDepth = 0;  // Frames that finished early and wait for their predecessors
+    uint64_t reorderWaits = 0;  // Times a worker held a finished frame because the reorder buffer was full
+    uint64_t framesDecoded = 0;
+    uint64_t framesProcessed = 0;
+    uint64_t framesDelivered = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const PipelineStats& stats);
+
+// Runs decode -> process -> display/encode as three overlapping stages:
+//  * one decode thread calls the source and fills the decode queue,
+//  * N worker threads take frames from it and run the processor,
+//  * the sink runs on the thread calling run() (HighGUI must stay on the main thread) and gets the
+//    frames in their original order.
+// The stages are joined by bounded queues, so a slow stage makes the stages before it wait instead of
+// buffering frames without limit. The reorder buffer of the sink is bounded as well: a worker only hands over
+// a frame less than 2 * queueCapacity frames ahead of the next one the sink waits for (room for a full result
+// queue and as many frames in the reorder buffer), so a single slow frame stalls the pipeline instead of letting
+// the frames after it pile up. The throughput approaches the slowest stage instead of the sum of all.
+class FramePipeline {
+public:
+    // Returns false at the end of the stream
+    using Source = std::function<bool(cv::Mat& frame)>;
+    using Processor = std::function<void(const cv::Mat& source, cv::Mat& result)>;
+    // Called once per worker, so every worker can own its scratch buffers
+    using ProcessorFactory = std::function<Processor()>;
+    // Returns false to stop the pipeline
+    using Sink = std::function<bool(const FramePacket& packet)>;
+
+    explicit FramePipeline(size_t workers = 2, size_t queueCapacity = 4);
+
+    // Blocks until the source is exhausted or the sink asks to stop. A pipeline runs a single stream.
+    // Exceptions thrown by the source or the processors are rethrown here.
+    void run(const Source& source, const ProcessorFactory& makeProcessor, const Sink& sink);
+
+    PipelineStats stats() const;
+
+private:
+    size_t workers;
+    size_t reorderWindow;
+    BoundedQueue<FramePacket> decodeQueue;
+    BoundedQueue<FramePacket> resultQueue;
+    std::atomic<size_t> reorderDepth{0};
+    std::atomic<uint64_t> reorderWaits{0};
+    std::atomic<uint64_t> framesDecoded{0};
+    std::atomic<uint64_t> framesProcessed{0};
+    std::atomic<uint64_t> framesDelivered{0};
+};
@@ -0,0 +1,105 @@
+#include "mat_qimage.h"
+
+// Releases the reference a QImage holds on the buffer of a Mat
+static void releaseMat(void* info) {
+    delete static_cast<cv::Mat*>(info);
+}
+
+// Builds a read-only QImage on top of the Mat's buffer; the QImage owns a reference to the buffer
+static QImage wrapMat(const cv::Mat& mat, QImage::Format format) {
+    cv::Mat* keepAlive = new cv::Mat(mat);
+    return QImage(static_cast<const uchar*>(keepAlive->data), keepAlive->cols, keepAlive->rows, static_cast<int>(keepAlive->step),
+                  format, releaseMat, keepAlive);
+}
+
+static QImage::Format sharedFormat(const cv::Mat& mat) {
+    switch (mat.type()) {
+        case CV_8UC1:
+            return QImage::Format_Grayscale8;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        case CV_8UC3:
+            return QImage::Format_BGR888;
+#endif
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        case CV_8UC4:
+            return QImage::Format_ARGB32;  // B, G, R, A in memory
+#endif
+        default:
+            return QImage::Format_Invalid;
+    }
+}
+
+QImage matToQImageShared(const cv::Mat& mat) {
+    QImage::Format format = sharedFormat(mat);
+    if (mat.empty() || format == QImage::Format_Invalid)
+        return QImage();
+    return wrapMat(mat, format);
+}
+
+QImage matToQImage(const cv::Mat& mat) {
+    MatToQImageConverter converter;
+    return converter.convert(mat);
+}
+
+cv::Mat qImageToMatShared(const QImage& image) {
+    int type;
+    switch (image.format()) {
+        case QImage::Format_Grayscale8:
+            type = CV_8UC1;
+            break;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+        case QImage::Format_BGR888:
+            type = CV_8UC3;
+            break;
+#endif
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        case QImage::Format_RGB32:
+        case QImage::Format_ARGB32:
+            type = CV_8UC4;  // B, G, R, A in memory
+            break;
+#endif
+        default:
+            // Format_RGB888 among others: OpenCV would read its R, G, B bytes as B, G, R and swap the colors
+            return cv::Mat();
+    }
+    return cv::Mat(image.height(), image.width(), type,
+                   const_cast<uchar*>(image.constBits()), static_cast<size_t>(image.bytesPerLine()));
+}
+
+QImage MatToQImageConverter::convert(const cv::Mat& mat) {
+    if (mat.empty())
+        return QImage();
+
+    QImage shared = matToQImageShared(mat);
+    if (!shared.isNull())
+        return shared;
+    if (mat.channels() == 2)
+        return QImage();
+
+    // A QImage returned earlier may still be alive and point to the buffer; leave it alone in that case
+    if (rgbBuffer.u && rgbBuffer.u->refcount > 1)
+        rgbBuffer.release();
+
+    switch (mat.type()) {
+        case CV_8UC3:
+            cv::cvtColor(mat, rgbBuffer, cv::COLOR_BGR2RGB);
+            break;
+        case CV_8UC4:
+            cv::cvtColor(mat, rgbBuffer, cv::COLOR_BGRA2RGB);
+            break;
+        case CV_8UC1:
+            cv::cvtColor(mat, rgbBuffer, cv::COLOR_GRAY2RGB);
+            break;
+        default: {
+            // Other depths are scaled to 8 bit first
+            cv::Mat scaled;
+            cv::normalize(mat, scaled, 0, 255, cv::NORM_MINMAX, CV_8U);
+            if (scaled.channels() == 1)
+                cv::cvtColor(scaled, rgbBuffer, cv::COLOR_GRAY2RGB);
+            else
+                cv::cvtColor(scaled, rgbBuffer, scaled.channels() == 4 ? cv::COLOR_BGRA2RGB : cv::COLOR_BGR2RGB);
+            break;
+        }
+    }
+    return wrapMat(rgbBuffer, QImage::Format_RGB888);
+}
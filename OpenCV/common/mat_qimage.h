@@ -0,0 +1,30 @@
+#pragma once
+#include <QImage>
+#include <opencv2/opencv.hpp>
+
+// Wraps the pixels of the Mat in a QImage without copying, if Qt has a format with the same memory layout:
+// CV_8UC1 -> Format_Grayscale8, CV_8UC3 (BGR) -> Format_BGR888 (Qt 5.14+), CV_8UC4 (BGRA) -> Format_ARGB32.
+// The QImage holds a reference to the Mat's buffer, so the pixels stay valid for as long as the QImage
+// (or any copy of it) lives, even after the Mat itself is released. Returns a null QImage for other types.
+QImage matToQImageShared(const cv::Mat& mat);
+
+// Same as matToQImageShared, but falls back to a converted copy for layouts Qt cannot use directly
+QImage matToQImage(const cv::Mat& mat);
+
+// Wraps the pixels of the QImage in a Mat without copying, for the formats whose memory layout is what OpenCV expects:
+// Grayscale8 -> CV_8UC1, BGR888 (Qt 5.14+) -> CV_8UC3 (BGR), RGB32/ARGB32 -> CV_8UC4 (BGRA, little-endian hosts).
+// The Mat does not own the pixels: the image must outlive it and must not be modified (a write to a shared QImage
+// detaches it). Returns an empty Mat for other formats. RGB888 is one of them, because OpenCV would take its channels
+// for B, G, R; convert it with image.convertToFormat(QImage::Format_BGR888) or cv::cvtColor(..., cv::COLOR_RGB2BGR).
+cv::Mat qImageToMatShared(const QImage& image);
+
+// Converts frames for display, e.g. before QPixmap::fromImage. Frames Qt can use as they are get shared; the others
+// are converted to RGB888 with a single vectorized cvtColor pass into a buffer that is reused for the next frame,
+// so a live feed does not allocate per frame. The buffer is only reused once the previous QImage was released.
+class MatToQImageConverter {
+public:
+    QImage convert(const cv::Mat& mat);
+
+private:
+    cv::Mat rgbBuffer;
+};
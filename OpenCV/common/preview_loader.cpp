@@ -0,0 +1,170 @@
+#include "preview_loader.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+cv::Size jpegImageSize(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (file.get() != 0xFF || file.get() != 0xD8)
+        return cv::Size();
+
+    // Walk the marker segments up to the frame header (SOF); its size sits in front of the compressed data
+    while (file) {
+        if (file.get() != 0xFF)
+            break;
+        int marker = file.get();
+        while (marker == 0xFF)  // Fill bytes
+            marker = file.get();
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD8))  // Markers without a segment
+            continue;
+        if (marker < 0 || marker == 0xD9 || marker == 0xDA)  // End of file, end of image or start of scan
+            break;
+
+        const int high = file.get();
+        const int length = (high << 8) | file.get();
+        if (!file || length < 2)
+            break;
+        // SOF0..SOF15 except DHT (C4), JPG (C8) and DAC (CC): precision, height, width
+        const bool frameHeader = marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+        if (frameHeader) {
+            unsigned char header[5];
+            if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+                break;
+            cv::Size size((header[3] << 8) | header[4], (header[1] << 8) | header[2]);
+            return size.area() > 0 ? size : cv::Size();
+        }
+        file.seekg(length - 2, std::ios::cur);
+    }
+    return cv::Size();
+}
+
+static double fitScale(cv::Size imageSize, cv::Size maxSize) {
+    return std::min({1.0, static_cast<double>(maxSize.width) / imageSize.width,
+                     static_cast<double>(maxSize.height) / imageSize.height});
+}
+
+cv::Size fitWithin(cv::Size imageSize, cv::Size maxSize) {
+    CV_Assert(imageSize.area() > 0 && maxSize.area() > 0);
+    const double scale = fitScale(imageSize, maxSize);
+    return cv::Size(std::max(1, cvRound(imageSize.width * scale)), std::max(1, cvRound(imageSize.height * scale)));
+}
+
+void downscaleToFit(const cv::Mat& image, cv::Mat& dst, cv::Size maxSize) {
+    const cv::Size size = fitWithin(image.size(), maxSize);
+    if (size == image.size())
+        dst = image;
+    else
+        cv::resize(image, dst, size, 0, 0, cv::INTER_AREA);
+}
+
+// Largest libjpeg reduction (1, 2, 4 or 8) that still decodes at least the preview size
+static int reducedDecodeFactor(cv::Size imageSize, cv::Size maxSize) {
+    // The EXIF orientation may swap width and height after decoding, the reduction has to suffice for both
+    const double scale = std::max(fitScale(imageSize, maxSize),
+                                  fitScale(cv::Size(imageSize.height, imageSize.width), maxSize));
+    int factor = 1;
+    while (factor < 8 && scale * factor * 2 <= 1.0)
+        factor *= 2;
+    return factor;
+}
+
+PreviewLoader::PreviewLoader(size_t threads, size_t cacheBytes) : cacheBytes(cacheBytes), pool(threads) {}
+
+cv::Mat PreviewLoader::decode(const std::string& path, cv::Size maxSize, int flags) const {
+    int decodeFlags = flags;
+    const cv::Size jpegSize = jpegImageSize(path);
+    if (!jpegSize.empty() && (flags == cv::IMREAD_COLOR || flags == cv::IMREAD_GRAYSCALE)) {
+        const bool color = flags == cv::IMREAD_COLOR;
+        switch (reducedDecodeFactor(jpegSize, maxSize)) {
+            case 2:
+                decodeFlags = color ? cv::IMREAD_REDUCED_COLOR_2 : cv::IMREAD_REDUCED_GRAYSCALE_2;
+                break;
+            case 4:
+                decodeFlags = color ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_GRAYSCALE_4;
+                break;
+            case 8:
+                decodeFlags = color ? cv::IMREAD_REDUCED_COLOR_8 : cv::IMREAD_REDUCED_GRAYSCALE_8;
+                break;
+        }
+    }
+
+    cv::Mat decoded = cv::imread(path, decodeFlags);
+    if (decoded.empty())
+        return decoded;
+    cv::Mat preview;
+    downscaleToFit(decoded, preview, maxSize);
+    return preview;
+}
+
+cv::Mat PreviewLoader::load(const std::string& path, cv::Size maxSize, int flags) {
+    CV_Assert(maxSize.area() > 0);
+    std::error_code error;
+    const auto modified = std::filesystem::last_write_time(path, error);
+    if (error)
+        return cv::Mat();
+    const uintmax_t fileSize = std::filesystem::file_size(path, error);
+    if (error)
+        return cv::Mat();
+
+    const Key key(path, static_cast<int64_t>(modified.time_since_epoch().count()), fileSize, maxSize.width,
+                  maxSize.height, flags);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(key);
+        if (found != index.end()) {
+            entries.splice(entries.begin(), entries, found->second);
+            ++hitCount;
+            return found->second->second;
+        }
+        ++missCount;
+    }
+
+    // Decoded without holding the lock, so the workers decode in parallel
+    cv::Mat preview = decode(path, maxSize, flags);
+    if (!preview.empty())
+        insert(key, preview);
+    return preview;
+}
+
+std::future<cv::Mat> PreviewLoader::loadAsync(const std::string& path, cv::Size maxSize, int flags) {
+    return pool.submit([this, path, maxSize, flags] { return load(path, maxSize, flags); });
+}
+
+void PreviewLoader::insert(const Key& key, const cv::Mat& preview) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (index.count(key))  // Another thread decoded the same preview in the meantime
+        return;
+    entries.emplace_front(key, preview);
+    index[key] = entries.begin();
+    usedBytes += preview.total() * preview.elemSize();
+
+    // The newest preview stays even if it alone exceeds the budget
+    while (usedBytes > cacheBytes && entries.size() > 1) {
+        const Entry& oldest = entries.back();
+        usedBytes -= oldest.second.total() * oldest.second.elemSize();
+        index.erase(oldest.first);
+        entries.pop_back();
+    }
+}
+
+void PreviewLoader::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+}
+
+size_t PreviewLoader::cachedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBytes;
+}
+
+uint64_t PreviewLoader::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hitCount;
+}
+
+uint64_t PreviewLoader::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return missCount;
+}
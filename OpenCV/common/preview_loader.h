@@ -0,0 +1,62 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include "thread_pool.h"
+
+// Width and height stored in the SOF header of a JPEG file, without decoding it; an empty Size if the file is not a
+// JPEG or the header could not be found. This is the size before any EXIF rotation.
+cv::Size jpegImageSize(const std::string& path);
+
+// Size of an image of imageSize scaled down to fit into maxSize with the same aspect ratio; never larger than imageSize
+cv::Size fitWithin(cv::Size imageSize, cv::Size maxSize);
+
+// Scales image down to fit into maxSize with area resampling (every source pixel contributes, no aliasing).
+// An image that already fits is shared, not copied.
+void downscaleToFit(const cv::Mat& image, cv::Mat& dst, cv::Size maxSize);
+
+// Loads images scaled down for display. A JPEG holds its pixels as 8x8 DCT blocks, and libjpeg can decode them at
+// 1/2, 1/4 or 1/8 of the size by computing only the low frequencies (IMREAD_REDUCED_*). The loader reads the size
+// from the header, picks the largest reduction that still leaves at least the requested size and finishes with
+// area resampling, so a 24 MP photo shown at 1500 pixels decodes about 1/16 of its pixels. Other formats are
+// decoded at full size and resampled.
+// Previews are kept in an LRU cache keyed by path, modification time, file size, requested size and flags, so a
+// changed file is decoded again. The returned Mats are shared with the cache: clone before writing into them.
+class PreviewLoader {
+public:
+    // threads = 0 uses one per core; cacheBytes limits the pixel data of the cached previews
+    explicit PreviewLoader(size_t threads = 0, size_t cacheBytes = size_t(128) << 20);
+
+    // flags: cv::IMREAD_COLOR or cv::IMREAD_GRAYSCALE. Returns an empty Mat if the file cannot be read.
+    cv::Mat load(const std::string& path, cv::Size maxSize, int flags = cv::IMREAD_COLOR);
+    // Same as load on a worker thread, e.g. to fill a folder view while the first previews are shown
+    std::future<cv::Mat> loadAsync(const std::string& path, cv::Size maxSize, int flags = cv::IMREAD_COLOR);
+
+    void clear();
+    size_t cachedBytes() const;
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+private:
+    // path, modification time, file size, preview width, preview height, flags
+    using Key = std::tuple<std::string, int64_t, uintmax_t, int, int, int>;
+    using Entry = std::pair<Key, cv::Mat>;
+
+    cv::Mat decode(const std::string& path, cv::Size maxSize, int flags) const;
+    void insert(const Key& key, const cv::Mat& preview);
+
+    const size_t cacheBytes;
+    mutable std::mutex mutex;
+    std::list<Entry> entries;  // Most recently used first
+    std::map<Key, std::list<Entry>::iterator> index;
+    size_t usedBytes = 0;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+    // Declared last, so the queued loads finish before the cache is destroyed
+    ThreadPool pool;
+};
@@ -0,0 +1,132 @@
+#include "raw_frame_store.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 4 KiB is the page size of x86 and most ARM systems; a larger page size would only cost alignment of the mapping
+static const size_t pageSize = 4096;
+static const size_t rowAlignment = 64;
+static const char rawFrameMagic[8] = {'C', 'V', 'R', 'A', 'W', 'F', 'R', 'M'};
+static const uint32_t rawFrameVersion = 1;
+
+struct RawFrameHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t type;
+    int32_t rows;
+    int32_t cols;
+    uint64_t step;
+    uint64_t dataBytes;  // Pixel data without the padding to the next page
+};
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// The Mat built from the header must stay inside the frame: a known type, rows that hold cols pixels, a step
+// cv::Mat accepts (a multiple of the element size of one channel) and exactly rows steps of pixel data
+static bool validLayout(const RawFrameHeader& header) {
+    // Every depth and channel count up to CV_CN_MAX
+    const int maxType = CV_MAKETYPE(CV_DEPTH_MAX - 1, CV_CN_MAX);
+    if (header.rows <= 0 || header.cols <= 0 || header.type < 0 || header.type > maxType)
+        return false;
+    const uint64_t rowBytes = static_cast<uint64_t>(header.cols) * CV_ELEM_SIZE(header.type);
+    if (header.step < rowBytes || header.step % CV_ELEM_SIZE1(header.type) != 0 ||
+        header.step > UINT64_MAX / static_cast<uint64_t>(header.rows))
+        return false;
+    return header.dataBytes == header.step * static_cast<uint64_t>(header.rows);
+}
+
+RawFrameWriter::RawFrameWriter(const std::string& path, bool append)
+    : file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc)), padding(pageSize, 0) {}
+
+bool RawFrameWriter::write(const cv::Mat& frame) {
+    CV_Assert(!frame.empty() && frame.dims == 2);
+    if (!isOpened())
+        return false;
+
+    const size_t rowBytes = frame.cols * frame.elemSize();
+    RawFrameHeader header{};
+    std::memcpy(header.magic, rawFrameMagic, sizeof(rawFrameMagic));
+    header.version = rawFrameVersion;
+    header.type = frame.type();
+    header.rows = frame.rows;
+    header.cols = frame.cols;
+    header.step = alignUp(rowBytes, rowAlignment);
+    header.dataBytes = header.step * frame.rows;
+
+    // The header fills a whole page, so the pixels start page-aligned
+    std::vector<char> headerPage(pageSize, 0);
+    std::memcpy(headerPage.data(), &header, sizeof(header));
+    file.write(headerPage.data(), headerPage.size());
+
+    for (int y = 0; y < frame.rows; ++y) {
+        file.write(reinterpret_cast<const char*>(frame.ptr(y)), rowBytes);
+        file.write(padding.data(), header.step - rowBytes);
+    }
+    file.write(padding.data(), alignUp(header.dataBytes, pageSize) - header.dataBytes);
+    file.flush();
+    if (!file.good())
+        return false;
+    ++written;
+    return true;
+}
+
+RawFrameReader::RawFrameReader(const std::string& path, bool copyOnWrite) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat info{};
+    if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+        mappedBytes = static_cast<size_t>(info.st_size);
+        void* address = copyOnWrite ? ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+                                    : ::mmap(nullptr, mappedBytes, PROT_READ, MAP_SHARED, fd, 0);
+        if (address != MAP_FAILED)
+            mapping = address;
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    if (!mapping)
+        return;
+
+    // Walk the frames; a truncated or foreign block ends the file, e.g. a frame that was still being written
+    const uchar* base = static_cast<const uchar*>(mapping);
+    size_t offset = 0;
+    try {
+        while (offset + pageSize <= mappedBytes) {
+            RawFrameHeader header;
+            std::memcpy(&header, base + offset, sizeof(header));
+            if (std::memcmp(header.magic, rawFrameMagic, sizeof(rawFrameMagic)) != 0 ||
+                header.version != rawFrameVersion)
+                break;
+            if (!validLayout(header) || header.dataBytes > mappedBytes - offset - pageSize)
+                break;
+            const size_t blockBytes = alignUp(header.dataBytes, pageSize);
+            if (blockBytes > mappedBytes - offset - pageSize)
+                break;
+            uchar* pixels = const_cast<uchar*>(base + offset + pageSize);
+            frames.emplace_back(header.rows, header.cols, header.type, pixels, static_cast<size_t>(header.step));
+            offset += pageSize + blockBytes;
+        }
+    } catch (...) {
+        // The destructor does not run for a constructor that throws
+        frames.clear();
+        ::munmap(mapping, mappedBytes);
+        mapping = nullptr;
+        throw;
+    }
+}
+
+RawFrameReader::~RawFrameReader() {
+    frames.clear();
+    if (mapping)
+        ::munmap(mapping, mappedBytes);
+}
+
+cv::Mat RawFrameReader::frame(size_t index) const {
+    CV_Assert(index < frames.size());
+    return frames[index];
+}
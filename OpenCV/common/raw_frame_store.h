@@ -0,0 +1,53 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Raw frame files: uncompressed pixels that are mapped into memory instead of decoded.
+// PNG spends most of its time in zlib and JPEG in the DCT; for intermediate results that are written by one
+// pipeline stage and read by the next, the plain pixels are cheaper both ways.
+// A file is a sequence of frames, each made of
+//  * a header of one page: magic, version, Mat type, rows, cols, row step, size of the pixel data,
+//  * the pixel rows, every row padded to a multiple of 64 bytes, the whole block padded to a page.
+// Because the pixel data starts on a page boundary, a reader maps the file and wraps every frame in a cv::Mat
+// header pointing into the mapping: no decode and no copy. Frames are only ever appended, so a writer can keep
+// adding frames to a file while earlier ones are already in use.
+
+// Appends frames to a raw frame file
+class RawFrameWriter {
+public:
+    // append = false truncates an existing file
+    explicit RawFrameWriter(const std::string& path, bool append = true);
+
+    bool isOpened() const { return file.is_open() && file.good(); }
+    // Any continuous or non-continuous Mat; false if the file could not be written
+    bool write(const cv::Mat& frame);
+    uint64_t framesWritten() const { return written; }
+
+private:
+    std::ofstream file;
+    uint64_t written = 0;
+    std::vector<char> padding;
+};
+
+// Maps a raw frame file. The Mats returned by frame() point into the mapping: they are valid as long as the reader
+// exists. By default the mapping is read-only and the frames must not be written to; with copyOnWrite the pages a
+// frame writes to are copied privately, the file itself never changes. Frames appended after opening are not seen.
+class RawFrameReader {
+public:
+    explicit RawFrameReader(const std::string& path, bool copyOnWrite = false);
+    ~RawFrameReader();
+    RawFrameReader(const RawFrameReader&) = delete;
+    RawFrameReader& operator=(const RawFrameReader&) = delete;
+
+    bool isOpened() const { return mapping != nullptr; }
+    size_t frameCount() const { return frames.size(); }
+    cv::Mat frame(size_t index) const;
+
+private:
+    void* mapping = nullptr;
+    size_t mappedBytes = 0;
+    std::vector<cv::Mat> frames;
+};
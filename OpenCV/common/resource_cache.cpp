@@ -0,0 +1,129 @@
+#include "resource_cache.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <unistd.h>
+#include "raw_frame_store.h"
+
+#ifndef RESOURCES_PATH
+#define RESOURCES_PATH "Undefined"
+#endif
+
+// Stored as the first frame of a cache file (one row of bytes), the decoded image is the second frame
+struct ImageCacheStamp {
+    char magic[8];
+    int64_t modified;  // Modification time of the source image
+    uint64_t size;     // File size of the source image
+    int32_t flags;     // cv::imread flags
+    int32_t reserved;
+};
+
+static const char imageCacheMagic[8] = {'C', 'V', 'I', 'M', 'C', 'A', 'C', 'H'};
+
+static bool currentStamp(const std::string& path, int flags, ImageCacheStamp& stamp) {
+    std::error_code error;
+    const auto modified = std::filesystem::last_write_time(path, error);
+    if (error)
+        return false;
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+        return false;
+
+    std::memset(&stamp, 0, sizeof(stamp));
+    std::memcpy(stamp.magic, imageCacheMagic, sizeof(imageCacheMagic));
+    stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    stamp.size = size;
+    stamp.flags = flags;
+    return true;
+}
+
+// Type cv::imread returns for the flags, -1 if it depends on the file
+static int decodedType(int flags) {
+    if (flags < 0 || (flags & (cv::IMREAD_ANYDEPTH | cv::IMREAD_ANYCOLOR)))
+        return -1;
+    return (flags & cv::IMREAD_COLOR) ? CV_8UC3 : CV_8UC1;
+}
+
+static bool matchesStamp(const RawFrameReader& reader, const ImageCacheStamp& stamp) {
+    if (reader.frameCount() != 2)
+        return false;
+    cv::Mat stored = reader.frame(0);
+    if (stored.type() != CV_8UC1 || stored.total() != sizeof(stamp) ||
+        std::memcmp(stored.ptr(), &stamp, sizeof(stamp)) != 0)
+        return false;
+    const int type = decodedType(stamp.flags);
+    return type < 0 || reader.frame(1).type() == type;
+}
+
+// Owner of the mapping behind a cached image: the reader is deleted together with the last Mat that uses the pixels.
+// Mats of this allocator never allocate themselves; create() with a different size falls back to the default
+// allocator, like for any Mat wrapping external data.
+class MappedImageAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int, const int*, int, void*, size_t*, cv::AccessFlag, cv::UMatUsageFlags) const override {
+        return nullptr;
+    }
+    bool allocate(cv::UMatData*, cv::AccessFlag, cv::UMatUsageFlags) const override { return false; }
+    void deallocate(cv::UMatData* u) const override {
+        if (!u)
+            return;
+        CV_Assert(u->urefcount == 0 && u->refcount == 0);
+        delete static_cast<RawFrameReader*>(u->userdata);
+        delete u;
+    }
+};
+
+static MappedImageAllocator mappedImageAllocator;
+
+// A Mat sharing the pixels of the cached frame that keeps the reader (and so the mapping) alive
+static cv::Mat adoptMappedImage(std::unique_ptr<RawFrameReader> reader, size_t frameIndex) {
+    cv::Mat image = reader->frame(frameIndex);
+    cv::UMatData* u = new cv::UMatData(&mappedImageAllocator);
+    u->data = u->origdata = image.data;
+    u->size = image.step[0] * image.rows;
+    u->userdata = reader.release();
+    image.allocator = &mappedImageAllocator;
+    image.u = u;
+    image.addref();
+    return image;
+}
+
+std::string resourcePath(const std::string& relativePath) {
+    return std::string(RESOURCES_PATH) + relativePath;
+}
+
+cv::Mat loadCachedImage(const std::string& path, int flags) {
+    ImageCacheStamp stamp;
+    if (!currentStamp(path, flags, stamp))
+        return cv::imread(path, flags);
+    const std::string cachePath = path + ".imread" + std::to_string(flags) + ".cvraw";
+
+    // Every load gets its own mapping, so writing into one returned image does not show up in another
+    auto reader = std::make_unique<RawFrameReader>(cachePath, true);
+    if (reader->isOpened() && matchesStamp(*reader, stamp))
+        return adoptMappedImage(std::move(reader), 1);
+    reader.reset();
+
+    cv::Mat image = cv::imread(path, flags);
+    if (image.empty())
+        return image;
+
+    // Written under a temporary name and renamed, so another process never maps a half written file
+    const std::string temporaryPath = cachePath + "." + std::to_string(::getpid()) + ".tmp";
+    bool written;
+    {
+        RawFrameWriter writer(temporaryPath, false);
+        written = writer.write(cv::Mat(1, sizeof(stamp), CV_8UC1, &stamp)) && writer.write(image);
+    }
+    std::error_code error;
+    if (written)
+        std::filesystem::rename(temporaryPath, cachePath, error);
+    if (!written || error)
+        std::filesystem::remove(temporaryPath, error);
+    return image;
+}
+
+cv::Mat loadResourceImage(const std::string& relativePath, int flags) {
+    return loadCachedImage(resourcePath(relativePath), flags);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <string>
+
+// Absolute path of a file in the resources folder of the repository (RESOURCES_PATH, set by the root CMakeLists.txt)
+std::string resourcePath(const std::string& relativePath);
+
+// Loads an image like cv::imread, but keeps the decoded pixels in a raw frame file next to it
+// (e.g. lenna.jpg.imread1.cvraw for cv::IMREAD_COLOR). The cache file records the size and modification time of the
+// image it was decoded from; while they match, the next load of the image - by any of the example binaries - maps
+// the cache file instead of decoding again. An edited image is decoded and cached again. If the cache cannot be
+// written (read-only folder), the image is simply decoded every time.
+// The Mat returned from the cache points into a copy-on-write mapping of its own, which is unmapped together with the
+// last Mat sharing the pixels: writing into it is fine and never changes the cache file.
+cv::Mat loadCachedImage(const std::string& path, int flags = cv::IMREAD_COLOR);
+
+// loadCachedImage(resourcePath(relativePath), flags)
+cv::Mat loadResourceImage(const std::string& relativePath, int flags = cv::IMREAD_COLOR);
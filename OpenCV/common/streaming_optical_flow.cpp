@@ -0,0 +1,103 @@
+#include "streaming_optical_flow.h"
+#include <algorithm>
+
+StreamingOpticalFlow::StreamingOpticalFlow(const OpticalFlowOptions& options) : options(options) {
+    CV_Assert(options.maxPoints > 0 && options.minPoints <= options.maxPoints && options.batchSize > 0);
+}
+
+const std::vector<TrackedPoint>& StreamingOpticalFlow::update(const cv::Mat& frame) {
+    CV_Assert(!frame.empty());
+    if (frame.channels() == 1)
+        frame.copyTo(gray);
+    else
+        cv::cvtColor(frame, gray, frame.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+
+    cv::buildOpticalFlowPyramid(gray, pyramid, options.winSize, options.maxLevel, true);
+
+    if (!previousPyramid.empty() && previousSize == gray.size())
+        trackPoints();
+    else
+        tracked.clear();
+
+    if (static_cast<int>(tracked.size()) < options.minPoints)
+        replenish();
+
+    // This frame's pyramid is the previous one of the next frame; the old buffers are reused for the next build
+    std::swap(previousPyramid, pyramid);
+    previousSize = gray.size();
+    ++frames;
+    return tracked;
+}
+
+void StreamingOpticalFlow::trackPoints() {
+    const int count = static_cast<int>(tracked.size());
+    if (count == 0)
+        return;
+
+    std::vector<cv::Point2f> from(count), to(count);
+    std::vector<uchar> status(count);
+    for (int i = 0; i < count; ++i)
+        from[i] = tracked[i].position;
+
+    // Each batch is an independent calcOpticalFlowPyrLK call on the shared pyramids
+    const int batches = (count + options.batchSize - 1) / options.batchSize;
+    cv::parallel_for_(cv::Range(0, batches), [&](const cv::Range& range) {
+        std::vector<cv::Point2f> batchFrom, batchTo;
+        std::vector<uchar> batchStatus;
+        std::vector<float> batchError;
+        for (int b = range.start; b < range.end; ++b) {
+            const int start = b * options.batchSize;
+            const int end = std::min(count, start + options.batchSize);
+            batchFrom.assign(from.begin() + start, from.begin() + end);
+            cv::calcOpticalFlowPyrLK(previousPyramid, pyramid, batchFrom, batchTo, batchStatus, batchError,
+                                     options.winSize, options.maxLevel);
+            std::copy(batchTo.begin(), batchTo.end(), to.begin() + start);
+            std::copy(batchStatus.begin(), batchStatus.end(), status.begin() + start);
+        }
+    });
+
+    // Keep the points that were found and are still inside the frame
+    const cv::Rect frameRect(0, 0, gray.cols, gray.rows);
+    size_t kept = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!status[i] || !frameRect.contains(cv::Point(cvRound(to[i].x), cvRound(to[i].y))))
+            continue;
+        TrackedPoint& point = tracked[kept++];
+        point = tracked[i];
+        point.previous = point.position;
+        point.position = to[i];
+        ++point.age;
+    }
+    tracked.resize(kept);
+}
+
+void StreamingOpticalFlow::replenish() {
+    // New features are only searched away from the points still being tracked
+    cv::Mat mask(gray.size(), CV_8UC1, cv::Scalar(255));
+    const int radius = std::max(1, cvRound(options.minDistance));
+    for (const TrackedPoint& point : tracked)
+        cv::circle(mask, point.position, radius, cv::Scalar(0), -1);
+
+    std::vector<cv::Point2f> corners;
+    cv::goodFeaturesToTrack(gray, corners, options.maxPoints - static_cast<int>(tracked.size()),
+                            options.qualityLevel, options.minDistance, mask);
+    for (const cv::Point2f& corner : corners) {
+        TrackedPoint point;
+        point.id = nextId++;
+        point.position = point.previous = corner;
+        tracked.push_back(point);
+    }
+    ++detections;
+}
+
+void StreamingOpticalFlow::draw(cv::Mat& image, const cv::Scalar& color) const {
+    for (const TrackedPoint& point : tracked) {
+        cv::line(image, point.previous, point.position, color, 2);
+        cv::circle(image, point.position, 3, color, -1);
+    }
+}
+
+void StreamingOpticalFlow::reset() {
+    previousPyramid.clear();
+    tracked.clear();
+}
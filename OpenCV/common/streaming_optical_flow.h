@@ -0,0 +1,60 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+struct OpticalFlowOptions {
+    int maxPoints = 400;         // Features tracked at most
+    int minPoints = 200;         // New features are only detected when fewer than this survive
+    double qualityLevel = 0.01;  // goodFeaturesToTrack parameters of the replenishment
+    double minDistance = 8;
+    cv::Size winSize{21, 21};    // Lucas-Kanade window
+    int maxLevel = 3;            // Pyramid levels above the full resolution
+    int batchSize = 64;          // Points tracked by one parallel task
+};
+
+// A feature followed from frame to frame
+struct TrackedPoint {
+    uint64_t id = 0;        // Stays the same while the feature is tracked
+    cv::Point2f position;   // In the current frame
+    cv::Point2f previous;   // In the previous frame (== position for a new feature)
+    int age = 0;            // Frames the feature has been tracked
+};
+
+// Sparse Lucas-Kanade optical flow over a video stream.
+// The pyramid (with its derivatives) of every frame is built once and kept as the "previous" pyramid of the next
+// frame, instead of building both pyramids again for every pair as cv::calcOpticalFlowPyrLK on two images does.
+// The points are tracked in batches in parallel; lost points are only replaced by new features once fewer than
+// minPoints survive, so the feature detection runs on a fraction of the frames.
+// Frames must be passed in order, e.g. from the sink of a FramePipeline.
+class StreamingOpticalFlow {
+public:
+    explicit StreamingOpticalFlow(const OpticalFlowOptions& options = OpticalFlowOptions());
+
+    // Tracks the points of the previous frame into this one (BGR or gray) and returns the surviving and new points
+    const std::vector<TrackedPoint>& update(const cv::Mat& frame);
+
+    const std::vector<TrackedPoint>& points() const { return tracked; }
+
+    // Draws every point with a line to its previous position
+    void draw(cv::Mat& image, const cv::Scalar& color = cv::Scalar(0, 255, 0)) const;
+
+    // Forgets the previous frame and the points, e.g. after a scene cut or a seek
+    void reset();
+
+    uint64_t framesProcessed() const { return frames; }
+    uint64_t replenishments() const { return detections; }
+
+private:
+    void trackPoints();
+    void replenish();
+
+    OpticalFlowOptions options;
+    cv::Mat gray;
+    std::vector<cv::Mat> previousPyramid, pyramid;
+    cv::Size previousSize;
+    std::vector<TrackedPoint> tracked;
+    uint64_t nextId = 0;
+    uint64_t frames = 0;
+    uint64_t detections = 0;
+};
@@ -4,14 +4,14 @@
 #include <QImage>
 #include <QPixmap>
 #include <opencv2/opencv.hpp>
+#include "mat_qimage.h"
 
 int main(int argc, char** argv) {
     QApplication app(argc, argv);
 
     cv::Mat image = cv::imread("/mnt/c/Data/images/440465443_411021305017410_1160088114663718974_n.jpg"); // Kép betöltése
-    cv::cvtColor(image, image, cv::COLOR_BGR2RGB);  // Convert color to RGB
 
-    QImage img((const uchar*) image.data, image.cols, image.rows, image.step, QImage::Format_RGB888);
+    QImage img = matToQImage(image);  // On Qt 5.14+ the BGR pixels are shared with Qt, older versions get an RGB copy
     QPixmap pixmap = QPixmap::fromImage(img);
 
     QLabel label;
@@ -13,10 +13,17 @@ endmacro()
 
 macro(add_opencv_executable name sources)
     add_executable(${name} ${sources})
-    target_link_libraries(${name} )
+    target_link_libraries(${name} ${OpenCV_LIBS})
     message("=== Defined binary: ${name} ===")
 endmacro()
 
+macro(add_opencv_library name sources)
+    add_library(${name} STATIC ${sources})
+    target_link_libraries(${name} PUBLIC ${OpenCV_LIBS} Threads::Threads)
+    target_include_directories(${name} PUBLIC ${CMAKE_CURRENT_SOURCE_DIR})
+    message("=== Defined library: ${name} ===")
+endmacro()
+
 macro(add_qt_cv_executable name sources)
     add_executable(${name} ${sources})
     target_link_libraries(${name} Qt5::Widgets Qt5::Core Qt5::Gui ${OpenCV_LIBS})